@@ -0,0 +1,261 @@
+#ifndef INCLUDE_BENCH
+#define INCLUDE_BENCH
+
+// 最小的基准测试工具：计时、防止优化掉结果、以 JSON 输出结果。
+// 每个 bench/*.cpp 都是独立程序，例如：
+//     g++ -std=c++17 -O2 -I.. ptr_variant.cpp -o ptr_variant && ./ptr_variant
+// 在 Linux 上同时通过 perf_event_open 读取硬件计数器（周期、指令、分支、分支预测失败、L1D / LLC / dTLB 未命中），
+// 结果写入 JSON 的 "counters" 字段；容器中或 perf_event_paranoid 不允许时自动退化为只计时。
+// 定义 BENCH_NO_COUNTERS 可以关闭计数器。
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#if defined(__linux__) && !defined(BENCH_NO_COUNTERS)
+#define BENCH_PERF_EVENTS
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace bench
+{
+    template <typename T>
+    inline void do_not_optimize(T const &value)
+    {
+#if defined(__GNUC__) || defined(__clang__)
+        asm volatile("" : : "r,m"(value) : "memory");
+#else
+        static volatile const void *sink;
+        sink = &value;
+#endif
+    }
+
+    struct CounterValue
+    {
+        const char *name;
+        uint64_t value;
+    };
+
+#ifdef BENCH_PERF_EVENTS
+    // PERF_TYPE_HW_CACHE 的 config：某级缓存的读未命中
+    constexpr uint64_t perf_cache_miss(uint64_t cache) noexcept
+    {
+        return cache | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+    }
+#endif
+
+    // 作为一个事件组打开的硬件计数器，只统计用户态。第一个打开成功的计数器是组长，其余加入它的组，
+    // 内核总是同时调度整组，一次 read 原子地读出所有值，因此各计数之间的比值（IPC、每条指令的分支预测失败等）
+    // 来自同一段时间。打不开的计数器直接跳过，一个都打不开时 available() 为 false。
+    // 整组被内核分时复用时，所有计数按同一个实际运行时间的比例换算。
+    class PerfCounters
+    {
+    public:
+        constexpr static size_t counter_count = 7;
+
+    private:
+#ifdef BENCH_PERF_EVENTS
+        struct event
+        {
+            const char *name;
+            uint32_t type;
+            uint64_t config;
+        };
+
+        constexpr static std::array<event, counter_count> events{{
+            {"cycles", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+            {"instructions", PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+            {"branches", PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_INSTRUCTIONS},
+            {"branch_misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+            {"l1d_misses", PERF_TYPE_HW_CACHE, perf_cache_miss(PERF_COUNT_HW_CACHE_L1D)},
+            {"llc_misses", PERF_TYPE_HW_CACHE, perf_cache_miss(PERF_COUNT_HW_CACHE_LL)},
+            {"dtlb_misses", PERF_TYPE_HW_CACHE, perf_cache_miss(PERF_COUNT_HW_CACHE_DTLB)},
+        }};
+
+        std::array<int, counter_count> m_fds;
+        // 组内第 k 个计数器对应的 events 下标，与 PERF_FORMAT_GROUP 读出的顺序一致
+        std::array<size_t, counter_count> m_members{};
+        size_t m_member_count{0};
+        int m_leader{-1};
+#endif
+        bool m_available{false};
+
+    public:
+        PerfCounters()
+        {
+#ifdef BENCH_PERF_EVENTS
+            for (size_t i = 0; i < counter_count; ++i)
+            {
+                perf_event_attr attr{};
+                attr.size = sizeof(attr);
+                attr.type = events[i].type;
+                attr.config = events[i].config;
+                // 组员跟随组长启停，只有组长初始为停止状态
+                attr.disabled = m_leader < 0;
+                attr.exclude_kernel = 1;
+                attr.exclude_hv = 1;
+                attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+                m_fds[i] = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, m_leader, 0));
+                if (m_fds[i] < 0)
+                    continue;
+                if (m_leader < 0)
+                    m_leader = m_fds[i];
+                m_members[m_member_count++] = i;
+            }
+            m_available = m_leader >= 0;
+#endif
+        }
+
+        PerfCounters(const PerfCounters &) = delete;
+        PerfCounters &operator=(const PerfCounters &) = delete;
+
+        ~PerfCounters()
+        {
+#ifdef BENCH_PERF_EVENTS
+            for (int fd : m_fds)
+                if (fd >= 0)
+                    close(fd);
+#endif
+        }
+
+        bool available() const noexcept { return m_available; }
+
+        void start() noexcept
+        {
+#ifdef BENCH_PERF_EVENTS
+            if (m_leader >= 0)
+            {
+                ioctl(m_leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+                ioctl(m_leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+            }
+#endif
+        }
+
+        void stop() noexcept
+        {
+#ifdef BENCH_PERF_EVENTS
+            if (m_leader >= 0)
+                ioctl(m_leader, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+#endif
+        }
+
+        // 上一次 start / stop 之间的计数；没有运行过的计数器不出现在结果中
+        std::vector<CounterValue> read() const
+        {
+            std::vector<CounterValue> values;
+#ifdef BENCH_PERF_EVENTS
+            // PERF_FORMAT_GROUP：nr, time_enabled, time_running, 然后按加入顺序排列的 nr 个值
+            uint64_t data[3 + counter_count];
+            if (m_leader < 0)
+                return values;
+            auto bytes = ::read(m_leader, data, sizeof(data));
+            if (bytes < static_cast<ssize_t>(3 * sizeof(uint64_t)) || data[0] != m_member_count ||
+                bytes != static_cast<ssize_t>((3 + data[0]) * sizeof(uint64_t)) || data[2] == 0)
+                return values;
+            for (size_t k = 0; k < m_member_count; ++k)
+            {
+                auto value = data[2] < data[1] ? static_cast<uint64_t>(static_cast<double>(data[3 + k]) * data[1] / data[2]) : data[3 + k];
+                values.push_back({events[m_members[k]].name, value});
+            }
+#endif
+            return values;
+        }
+    };
+
+    struct Result
+    {
+        std::string name;
+        uint64_t ops;
+        double seconds;
+        // 最快那一次运行的硬件计数，计数器不可用时为空
+        std::vector<CounterValue> counters{};
+
+        double ns_per_op() const { return ops ? seconds * 1e9 / ops : 0.0; }
+
+        // 没有该计数器时返回 -1
+        double per_op(const char *counter) const
+        {
+            for (const auto &c : counters)
+                if (std::string(c.name) == counter)
+                    return ops ? static_cast<double>(c.value) / ops : 0.0;
+            return -1.0;
+        }
+    };
+
+    // 运行 f() 一次预热，再运行 repeat 次取最快的一次；f 每次执行 ops 个操作。
+    // 给出 counters 时同时记录每次运行的硬件计数，保留最快那一次的
+    template <typename F>
+    Result measure(std::string name, uint64_t ops, F &&f, int repeat = 5, PerfCounters *counters = nullptr)
+    {
+        using clock = std::chrono::steady_clock;
+
+        if (counters && !counters->available())
+            counters = nullptr;
+
+        f();
+        Result result{std::move(name), ops, 0.0};
+        for (int i = 0; i < repeat; ++i)
+        {
+            if (counters)
+                counters->start();
+            auto start = clock::now();
+            f();
+            double elapsed = std::chrono::duration<double>(clock::now() - start).count();
+            if (counters)
+                counters->stop();
+            if (i == 0 || elapsed < result.seconds)
+            {
+                result.seconds = elapsed;
+                if (counters)
+                    result.counters = counters->read();
+            }
+        }
+        return result;
+    }
+
+    class Reporter
+    {
+    private:
+        std::vector<Result> m_results;
+        PerfCounters m_counters;
+
+    public:
+        bool counters_available() const noexcept { return m_counters.available(); }
+
+        template <typename F>
+        const Result &run(std::string name, uint64_t ops, F &&f, int repeat = 5)
+        {
+            m_results.push_back(measure(std::move(name), ops, std::forward<F>(f), repeat, &m_counters));
+            return m_results.back();
+        }
+
+        void print_json(std::ostream &os) const
+        {
+            os << "[\n";
+            for (size_t i = 0; i < m_results.size(); ++i)
+            {
+                const auto &r = m_results[i];
+                os << "  {\"name\": \"" << r.name << "\", \"ops\": " << r.ops
+                   << ", \"seconds\": " << r.seconds << ", \"ns_per_op\": " << r.ns_per_op();
+                if (!r.counters.empty())
+                {
+                    os << ", \"counters\": {";
+                    for (size_t c = 0; c < r.counters.size(); ++c)
+                        os << (c ? ", " : "") << "\"" << r.counters[c].name << "\": " << r.counters[c].value;
+                    os << "}";
+                }
+                os << "}" << (i + 1 < m_results.size() ? ",\n" : "\n");
+            }
+            os << "]\n";
+        }
+    };
+}
+
+#endif // INCLUDE_BENCH
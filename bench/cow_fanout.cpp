@@ -0,0 +1,51 @@
+// 扇出拷贝：把同一个值拷贝到许多下游时，Cow 的拷贝成本与负载大小无关，普通备选类型则随大小线性增长。
+//     g++ -std=c++17 -O2 -I.. cow_fanout.cpp -o cow_fanout && ./cow_fanout
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "bench.hpp"
+#include "variant_cow.hpp"
+
+struct Document
+{
+    std::vector<char> body;
+
+    bool operator==(const Document &other) const { return body == other.body; }
+};
+
+using Plain = Variant<int64_t, Document>;
+using Shared = Variant<int64_t, Cow<Document>>;
+// 只在单线程中使用的副本：直接选用非原子引用计数
+using Local = Variant<int64_t, Cow<Document, false>>;
+
+template <typename V>
+void fan_out(bench::Reporter &reporter, const std::string &name, const V &source, size_t fan)
+{
+    std::vector<V> sinks(fan);
+    reporter.run(name, fan, [&]
+                 {
+                     for (auto &sink : sinks)
+                         sink = source;
+                     bench::do_not_optimize(sinks.data()); });
+}
+
+int main()
+{
+    constexpr size_t fan = 1 << 12;
+
+    bench::Reporter reporter;
+    for (size_t bytes : {64, 4096, 262144})
+    {
+        auto suffix = "/" + std::to_string(bytes) + "B";
+        Document document{std::vector<char>(bytes, 'x')};
+
+        fan_out(reporter, "copy/plain" + suffix, Plain(document), fan);
+        fan_out(reporter, "copy/cow_atomic" + suffix, Shared(Cow<Document>(document)), fan);
+        fan_out(reporter, "copy/cow_local" + suffix, Local(Cow<Document, false>(document)), fan);
+    }
+
+    reporter.print_json(std::cout);
+    return 0;
+}
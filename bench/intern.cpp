@@ -0,0 +1,108 @@
+// 合并池：插入 / 查找吞吐量（单线程与多线程）以及相对于直接保存全部值的内存占用。
+//     g++ -std=c++17 -O2 -pthread -I.. intern.cpp -o intern && ./intern
+
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "bench.hpp"
+#include "variant_intern.hpp"
+
+struct Symbol
+{
+    uint32_t id;
+
+    bool operator==(const Symbol &other) const { return id == other.id; }
+};
+
+template <>
+struct std::hash<Symbol>
+{
+    size_t operator()(const Symbol &symbol) const noexcept { return symbol.id; }
+};
+
+using Value = Variant<int64_t, std::string, Symbol>;
+using Interner = VariantInterner<int64_t, std::string, Symbol>;
+
+int main()
+{
+    constexpr size_t count = 1 << 22;
+    constexpr size_t distinct = count / 16;
+
+    // 大部分是重复值
+    std::mt19937_64 rng(42);
+    std::vector<Value> values;
+    values.reserve(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        auto key = rng() % distinct;
+        switch (key % 3)
+        {
+        case 0:
+            values.emplace_back(static_cast<int64_t>(key));
+            break;
+        case 1:
+            values.emplace_back("identifier_" + std::to_string(key));
+            break;
+        default:
+            values.emplace_back(Symbol{static_cast<uint32_t>(key)});
+            break;
+        }
+    }
+
+    bench::Reporter reporter;
+    reporter.run("intern/1_thread", count, [&]
+                 {
+                     Interner pool;
+                     for (const auto &v : values)
+                         bench::do_not_optimize(pool.intern(v)); }, 3);
+
+    const unsigned threads = std::max(2u, std::min(8u, std::thread::hardware_concurrency()));
+    reporter.run("intern/" + std::to_string(threads) + "_threads", count, [&]
+                 {
+                     Interner pool;
+                     std::vector<std::thread> workers;
+                     for (unsigned t = 0; t < threads; ++t)
+                         workers.emplace_back([&, t]
+                                              {
+                                                  for (size_t i = t; i < count; i += threads)
+                                                      bench::do_not_optimize(pool.intern(values[i])); });
+                     for (auto &w : workers)
+                         w.join(); }, 3);
+
+    Interner pool;
+    std::vector<Interner::id_type> ids;
+    ids.reserve(count);
+    for (const auto &v : values)
+        ids.push_back(pool.intern(v));
+
+    reporter.run("find", count, [&]
+                 {
+                     for (const auto &v : values)
+                         bench::do_not_optimize(pool.find(v)); });
+
+    // 已合并的值比较 id，未合并的值逐个比较
+    reporter.run("equal/value", count, [&]
+                 {
+                     size_t same = 0;
+                     for (size_t i = 1; i < count; ++i)
+                         same += values[i] == values[i - 1];
+                     bench::do_not_optimize(same); });
+
+    reporter.run("equal/id", count, [&]
+                 {
+                     size_t same = 0;
+                     for (size_t i = 1; i < count; ++i)
+                         same += ids[i] == ids[i - 1];
+                     bench::do_not_optimize(same); });
+
+    std::cerr << "distinct values: " << pool.size() << " of " << count << "\n"
+              << "plain storage:   " << count * sizeof(Value) << " bytes\n"
+              << "interned:        " << pool.memory_usage() + ids.size() * sizeof(Interner::id_type)
+              << " bytes (pool " << pool.memory_usage() << " + ids)\n";
+
+    reporter.print_json(std::cout);
+    return 0;
+}
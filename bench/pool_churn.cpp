@@ -0,0 +1,107 @@
+// 堆上备选类型的构造 / 销毁：Box 从内存池分配，对比同样布局但通过特化 box_allocator 改用 operator new 的版本。
+//     g++ -std=c++17 -O2 -I.. pool_churn.cpp -o pool_churn && ./pool_churn
+
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "bench.hpp"
+#include "variant_pool.hpp"
+
+struct Order
+{
+    int64_t id;
+    double price;
+    int64_t quantity;
+    char symbol[40];
+
+    bool operator==(const Order &other) const { return id == other.id; }
+};
+
+struct HeapOrder : Order
+{
+};
+
+namespace variant_utils
+{
+    template <>
+    struct box_allocator<HeapOrder>
+    {
+        static void *allocate() { return ::operator new(sizeof(HeapOrder)); }
+        static void deallocate(void *ptr) noexcept { ::operator delete(ptr); }
+    };
+}
+
+using Pooled = Variant<int64_t, Box<Order>>;
+using Heap = Variant<int64_t, Box<HeapOrder>>;
+
+int main()
+{
+    constexpr size_t ops = 1 << 22;
+    constexpr size_t slots = 1 << 12;
+
+    // 随机替换固定数量的槽位：每次销毁一个旧值、构造一个新值
+    std::mt19937 rng(42);
+    std::vector<uint32_t> picks(ops);
+    for (auto &p : picks)
+        p = rng();
+
+    bench::Reporter reporter;
+    reporter.run("replace/operator_new", ops, [&]
+                 {
+                     std::vector<Heap> live(slots);
+                     for (size_t i = 0; i < ops; ++i)
+                     {
+                         auto &slot = live[picks[i] % slots];
+                         if (picks[i] & (1u << 31))
+                             slot = Heap(static_cast<int64_t>(i));
+                         else
+                             slot = Heap(Box<HeapOrder>(HeapOrder{{static_cast<int64_t>(i), 1.0, 100, {}}}));
+                     }
+                     bench::do_not_optimize(live.data()); });
+
+    reporter.run("replace/box", ops, [&]
+                 {
+                     std::vector<Pooled> live(slots);
+                     for (size_t i = 0; i < ops; ++i)
+                     {
+                         auto &slot = live[picks[i] % slots];
+                         if (picks[i] & (1u << 31))
+                             slot = Pooled(static_cast<int64_t>(i));
+                         else
+                             slot = Pooled(Box<Order>(Order{static_cast<int64_t>(i), 1.0, 100, {}}));
+                     }
+                     bench::do_not_optimize(live.data()); });
+
+    // 按帧构造一大批值再整体丢弃
+    constexpr size_t frame = 1 << 16;
+    reporter.run("frame/operator_new", ops, [&]
+                 {
+                     std::vector<Heap> values;
+                     values.reserve(frame);
+                     for (size_t i = 0; i < ops; i += frame)
+                     {
+                         for (size_t j = 0; j < frame; ++j)
+                             values.emplace_back(Box<HeapOrder>(HeapOrder{{static_cast<int64_t>(j), 1.0, 100, {}}}));
+                         bench::do_not_optimize(values.data());
+                         values.clear();
+                     } });
+
+    reporter.run("frame/box", ops, [&]
+                 {
+                     std::vector<Pooled> values;
+                     values.reserve(frame);
+                     VariantPool pool;
+                     VariantPoolScope scope(pool);
+                     for (size_t i = 0; i < ops; i += frame)
+                     {
+                         for (size_t j = 0; j < frame; ++j)
+                             values.emplace_back(Box<Order>(Order{static_cast<int64_t>(j), 1.0, 100, {}}));
+                         bench::do_not_optimize(values.data());
+                         values.clear();
+                         pool.reset();
+                     } });
+
+    reporter.print_json(std::cout);
+    return 0;
+}
@@ -0,0 +1,135 @@
+// 指针追逐基准：节点之间用 Variant<A *, B *> 或 PtrVariant<A *, B *> 相连，
+// 按随机顺序遍历整条链，比较两种链接方式的节点大小与遍历耗时。
+//     g++ -std=c++17 -O2 -I.. ptr_variant.cpp -o ptr_variant && ./ptr_variant
+
+#include <algorithm>
+#include <iostream>
+#include <numeric>
+#include <random>
+#include <vector>
+
+#include "bench.hpp"
+#include "ptr_variant.hpp"
+
+struct FatA;
+struct FatB;
+using FatLink = Variant<FatA *, FatB *>;
+struct FatA
+{
+    FatLink next;
+    int64_t value;
+};
+struct FatB
+{
+    FatLink next;
+    int32_t value;
+    int32_t weight;
+};
+
+struct SlimA;
+struct SlimB;
+// 链接类型在节点定义之前实例化，此时节点仍是不完整类型，需要显式给出对齐
+template <>
+struct variant_utils::pointer_alignment<SlimA> : std::integral_constant<size_t, alignof(int64_t)>
+{
+};
+template <>
+struct variant_utils::pointer_alignment<SlimB> : std::integral_constant<size_t, alignof(int64_t)>
+{
+};
+using SlimLink = PtrVariant<SlimA *, SlimB *>;
+struct alignas(int64_t) SlimA
+{
+    SlimLink next;
+    int64_t value;
+};
+struct alignas(int64_t) SlimB
+{
+    SlimLink next;
+    int32_t value;
+    int32_t weight;
+};
+
+static_assert(sizeof(SlimLink) == sizeof(void *));
+static_assert(std::is_trivially_copyable_v<SlimLink>);
+
+template <typename A, typename B, typename Link>
+struct Graph
+{
+    std::vector<A> as;
+    std::vector<B> bs;
+    Link head;
+
+    explicit Graph(size_t n, uint32_t seed)
+        : as(n / 2), bs(n - n / 2)
+    {
+        // 随机打乱所有节点的访问顺序，并把它们串成一条链
+        std::vector<Link> order;
+        order.reserve(n);
+        for (auto &a : as)
+            order.push_back(Link(&a));
+        for (auto &b : bs)
+            order.push_back(Link(&b));
+        std::shuffle(order.begin(), order.end(), std::mt19937(seed));
+
+        for (size_t i = 0; i < n; ++i)
+        {
+            auto &link = order[i];
+            auto &next = order[(i + 1) % n];
+            if (link.template holds_alternative<A *>())
+            {
+                link.template get<A *>()->next = next;
+                link.template get<A *>()->value = static_cast<int64_t>(i);
+            }
+            else
+            {
+                link.template get<B *>()->next = next;
+                link.template get<B *>()->value = static_cast<int32_t>(i);
+            }
+        }
+        head = order.front();
+    }
+
+    uint64_t chase(size_t steps) const
+    {
+        uint64_t sum = 0;
+        // 沿链接原地读取，不拷贝 Link
+        const Link *cur = &head;
+        for (size_t i = 0; i < steps; ++i)
+        {
+            if (cur->template holds_alternative<A *>())
+            {
+                const A *node = cur->template get<A *>();
+                sum += node->value;
+                cur = &node->next;
+            }
+            else
+            {
+                const B *node = cur->template get<B *>();
+                sum += node->value;
+                cur = &node->next;
+            }
+        }
+        return sum;
+    }
+};
+
+int main()
+{
+    constexpr size_t nodes = size_t{1} << 21;
+    constexpr size_t steps = nodes;
+
+    Graph<FatA, FatB, FatLink> fat(nodes, 42);
+    Graph<SlimA, SlimB, SlimLink> slim(nodes, 42);
+
+    std::cerr << "sizeof(Variant<A *, B *>) = " << sizeof(FatLink) << ", sizeof(FatA) = " << sizeof(FatA) << "\n"
+              << "sizeof(PtrVariant<A *, B *>) = " << sizeof(SlimLink) << ", sizeof(SlimA) = " << sizeof(SlimA) << "\n";
+
+    bench::Reporter reporter;
+    reporter.run("chase/Variant", steps, [&]
+                 { bench::do_not_optimize(fat.chase(steps)); });
+    reporter.run("chase/PtrVariant", steps, [&]
+                 { bench::do_not_optimize(slim.chase(steps)); });
+    reporter.print_json(std::cout);
+    return 0;
+}
@@ -0,0 +1,201 @@
+// 可能失败的调用链：Result（and_then）、Variant<T, Error>、std::expected 与异常在不同失败率下的开销。
+// std::expected 需要 C++23 标准库，按 C++23 编译时一并测量：
+//     g++ -std=c++17 -O2 -I.. result.cpp -o result && ./result
+//     g++ -std=c++23 -O2 -I.. result.cpp -o result && ./result
+
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "bench.hpp"
+#include "variant_result.hpp"
+
+#if __has_include(<expected>)
+#include <expected>
+#endif
+
+struct ParseError
+{
+    char message[64];
+    int position;
+
+    bool operator==(const ParseError &other) const { return position == other.position; }
+};
+
+struct ParseException : std::exception
+{
+    int position;
+
+    explicit ParseException(int position) : position(position) {}
+};
+
+// 三步：解析、校验范围、换算
+#define NOINLINE __attribute__((noinline))
+
+NOINLINE Result<int64_t, ParseError> parse_result(const std::string &text)
+{
+    int64_t value = 0;
+    for (size_t i = 0; i < text.size(); ++i)
+    {
+        if (text[i] < '0' || text[i] > '9')
+            return Unexpected(ParseError{"not a digit", static_cast<int>(i)});
+        value = value * 10 + (text[i] - '0');
+    }
+    return value;
+}
+
+NOINLINE Result<int64_t, ParseError> check_result(int64_t value)
+{
+    if (value > 1000000)
+        return Unexpected(ParseError{"out of range", -1});
+    return value;
+}
+
+NOINLINE Variant<int64_t, ParseError> parse_variant(const std::string &text)
+{
+    int64_t value = 0;
+    for (size_t i = 0; i < text.size(); ++i)
+    {
+        if (text[i] < '0' || text[i] > '9')
+            return ParseError{"not a digit", static_cast<int>(i)};
+        value = value * 10 + (text[i] - '0');
+    }
+    return value;
+}
+
+NOINLINE Variant<int64_t, ParseError> check_variant(int64_t value)
+{
+    if (value > 1000000)
+        return ParseError{"out of range", -1};
+    return value;
+}
+
+#ifdef __cpp_lib_expected
+NOINLINE std::expected<int64_t, ParseError> parse_expected(const std::string &text)
+{
+    int64_t value = 0;
+    for (size_t i = 0; i < text.size(); ++i)
+    {
+        if (text[i] < '0' || text[i] > '9')
+            return std::unexpected(ParseError{"not a digit", static_cast<int>(i)});
+        value = value * 10 + (text[i] - '0');
+    }
+    return value;
+}
+
+NOINLINE std::expected<int64_t, ParseError> check_expected(int64_t value)
+{
+    if (value > 1000000)
+        return std::unexpected(ParseError{"out of range", -1});
+    return value;
+}
+#endif
+
+NOINLINE int64_t parse_throw(const std::string &text)
+{
+    int64_t value = 0;
+    for (size_t i = 0; i < text.size(); ++i)
+    {
+        if (text[i] < '0' || text[i] > '9')
+            throw ParseException(static_cast<int>(i));
+        value = value * 10 + (text[i] - '0');
+    }
+    return value;
+}
+
+NOINLINE int64_t check_throw(int64_t value)
+{
+    if (value > 1000000)
+        throw ParseException(-1);
+    return value;
+}
+
+int main()
+{
+    constexpr size_t count = 1 << 20;
+
+    std::cerr << "sizeof(Result<int64_t, ParseError>) = " << sizeof(Result<int64_t, ParseError>)
+              << ", sizeof(Variant<int64_t, ParseError>) = " << sizeof(Variant<int64_t, ParseError>) << "\n";
+#ifdef __cpp_lib_expected
+    std::cerr << "sizeof(std::expected<int64_t, ParseError>) = " << sizeof(std::expected<int64_t, ParseError>) << "\n";
+#else
+    std::cerr << "std::expected unavailable, build with -std=c++23 to measure it\n";
+#endif
+
+    bench::Reporter reporter;
+    for (int failure_percent : {0, 1, 10})
+    {
+        std::mt19937 rng(42);
+        std::vector<std::string> inputs(count);
+        for (auto &input : inputs)
+            input = static_cast<int>(rng() % 100) < failure_percent ? "12x4" : std::to_string(rng() % 100000);
+        auto suffix = "/" + std::to_string(failure_percent) + "%_fail";
+
+        reporter.run("result" + suffix, count, [&]
+                     {
+                         int64_t sum = 0;
+                         for (const auto &input : inputs)
+                         {
+                             auto r = parse_result(input).and_then(check_result).map([](int64_t v)
+                                                                                       { return v * 3; });
+                             sum += r ? *r : -1;
+                         }
+                         bench::do_not_optimize(sum); });
+
+        reporter.run("variant" + suffix, count, [&]
+                     {
+                         int64_t sum = 0;
+                         for (const auto &input : inputs)
+                         {
+                             auto parsed = parse_variant(input);
+                             if (!parsed.holds_alternative<int64_t>())
+                             {
+                                 sum += -1;
+                                 continue;
+                             }
+                             auto checked = check_variant(parsed.get<int64_t>());
+                             sum += checked.holds_alternative<int64_t>() ? checked.get<int64_t>() * 3 : -1;
+                         }
+                         bench::do_not_optimize(sum); });
+
+#ifdef __cpp_lib_expected
+        reporter.run("expected" + suffix, count, [&]
+                     {
+                         int64_t sum = 0;
+                         // and_then / transform 要到 __cpp_lib_expected >= 202211L 才有，手写同样的链
+                         for (const auto &input : inputs)
+                         {
+                             auto parsed = parse_expected(input);
+                             if (!parsed)
+                             {
+                                 sum += -1;
+                                 continue;
+                             }
+                             auto checked = check_expected(*parsed);
+                             sum += checked ? *checked * 3 : -1;
+                         }
+                         bench::do_not_optimize(sum); });
+#endif
+
+        reporter.run("exception" + suffix, count, [&]
+                     {
+                         int64_t sum = 0;
+                         for (const auto &input : inputs)
+                         {
+                             try
+                             {
+                                 sum += check_throw(parse_throw(input)) * 3;
+                             }
+                             catch (const ParseException &)
+                             {
+                                 sum += -1;
+                             }
+                         }
+                         bench::do_not_optimize(sum); });
+    }
+
+    reporter.print_json(std::cout);
+    return 0;
+}
@@ -0,0 +1,94 @@
+// 二进制序列化基准：编码、拷贝解码与零拷贝视图解码的吞吐量。
+//     g++ -std=c++17 -O2 -I.. serialize.cpp -o serialize && ./serialize
+
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "bench.hpp"
+#include "variant_serialize.hpp"
+
+struct Quote
+{
+    int64_t timestamp;
+    double bid;
+    double ask;
+};
+
+using Message = Variant<int64_t, double, Quote, std::string>;
+
+int main()
+{
+    constexpr size_t count = 1 << 20;
+
+    std::mt19937_64 rng(42);
+    std::vector<Message> messages;
+    messages.reserve(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        switch (rng() % 4)
+        {
+        case 0:
+            messages.emplace_back(static_cast<int64_t>(rng()));
+            break;
+        case 1:
+            messages.emplace_back(static_cast<double>(rng() % 1000) / 7);
+            break;
+        case 2:
+            messages.emplace_back(Quote{static_cast<int64_t>(i), 1.0, 1.5});
+            break;
+        default:
+            messages.emplace_back(std::string("symbol-") + std::to_string(rng() % 100));
+            break;
+        }
+    }
+
+    size_t bytes = 0;
+    for (const auto &m : messages)
+        bytes += variant_utils::serialized_size(m);
+    std::vector<char> buffer(bytes);
+    char *end = buffer.data() + buffer.size();
+    std::cerr << "encoded " << count << " messages into " << bytes << " bytes\n";
+
+    bench::Reporter reporter;
+    reporter.run("serialize", count, [&]
+                 {
+                     char *out = buffer.data();
+                     for (const auto &m : messages)
+                         out = variant_utils::serialize(out, end, m);
+                     bench::do_not_optimize(out); });
+
+    reporter.run("deserialize", count, [&]
+                 {
+                     const char *in = buffer.data();
+                     Message m;
+                     while (in != end)
+                     {
+                         in = variant_utils::deserialize(in, end, m);
+                         bench::do_not_optimize(m);
+                     } });
+
+    // 零拷贝视图读取；未对齐或非平凡类型时退回拷贝解码
+    reporter.run("deserialize_view", count, [&]
+                 {
+                     const char *in = buffer.data();
+                     VariantView<int64_t, double, Quote, std::string> view;
+                     Message fallback;
+                     while (in != end)
+                     {
+                         auto read = variant_utils::deserialize_view(in, end, view);
+                         if (read.status == variant_utils::view_status::ok)
+                         {
+                             in = read.next;
+                             bench::do_not_optimize(view);
+                         }
+                         else
+                         {
+                             in = variant_utils::deserialize(in, end, fallback);
+                             bench::do_not_optimize(fallback);
+                         }
+                     } });
+
+    reporter.print_json(std::cout);
+    return 0;
+}
@@ -0,0 +1,116 @@
+// 两个备选类型的 Variant：if 分发（默认）与函数指针表分发（branch_dispatch_limit = 0）的对比。
+//     g++ -std=c++17 -O2 -I.. small_dispatch.cpp -o small_dispatch && ./small_dispatch
+// 代码体积可以用 nm 比较各 *_branch / *_table 函数：
+//     nm -C --size-sort small_dispatch | grep -E "_(branch|table)\("
+
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "bench.hpp"
+#include "variant.hpp"
+
+struct Id
+{
+    int64_t value;
+
+    bool operator==(const Id &other) const { return value == other.value; }
+};
+
+struct Name
+{
+    std::string value;
+
+    bool operator==(const Name &other) const { return value == other.value; }
+};
+
+// 同一组备选类型，只在这里关闭 if 分发
+struct table_policy : variant_utils::default_variant_policy
+{
+    constexpr static size_t branch_dispatch_limit = 0;
+};
+
+using Branch = Variant<Id, Name>;
+using Table = variant_utils::with_policy_t<table_policy, Branch>;
+
+#define NOINLINE __attribute__((noinline))
+
+NOINLINE Branch copy_branch(const Branch &v) { return v; }
+NOINLINE Table copy_table(const Table &v) { return v; }
+NOINLINE bool equal_branch(const Branch &a, const Branch &b) { return a == b; }
+NOINLINE bool equal_table(const Table &a, const Table &b) { return a == b; }
+NOINLINE void destroy_branch(Branch *v) { v->~Branch(); }
+NOINLINE void destroy_table(Table *v) { v->~Table(); }
+
+template <typename V>
+NOINLINE size_t visit_sum(const std::vector<V> &values)
+{
+    size_t sum = 0;
+    for (const auto &v : values)
+        sum += v.visit([](const auto &alternative) -> size_t
+                       {
+                           if constexpr (std::is_same_v<Id, std::decay_t<decltype(alternative)>>)
+                               return static_cast<size_t>(alternative.value);
+                           else
+                               return alternative.value.size(); });
+    return sum;
+}
+
+template <typename V>
+void run(bench::Reporter &reporter, const std::string &suffix, V (*copy)(const V &), bool (*equal)(const V &, const V &),
+         void (*destroy)(V *))
+{
+    constexpr size_t count = 1 << 20;
+
+    std::mt19937 rng(42);
+    std::vector<V> values;
+    values.reserve(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (rng() % 4)
+            values.emplace_back(Id{static_cast<int64_t>(i)});
+        else
+            values.emplace_back(Name{"n" + std::to_string(i % 100)});
+    }
+
+    std::vector<V> copies;
+    copies.reserve(count);
+    reporter.run("copy" + suffix, count, [&]
+                 {
+                     copies.clear();
+                     for (const auto &v : values)
+                         copies.push_back(copy(v));
+                     bench::do_not_optimize(copies.data()); });
+
+    reporter.run("compare" + suffix, count, [&]
+                 {
+                     size_t same = 0;
+                     for (size_t i = 0; i < count; ++i)
+                         same += equal(values[i], copies[i]);
+                     bench::do_not_optimize(same); });
+
+    reporter.run("visit" + suffix, count, [&]
+                 { bench::do_not_optimize(visit_sum(values)); });
+
+    reporter.run("copy_destroy" + suffix, count, [&]
+                 {
+                     alignas(V) unsigned char buffer[sizeof(V)];
+                     for (const auto &v : values)
+                     {
+                         auto *p = new (buffer) V(v);
+                         bench::do_not_optimize(*p);
+                         destroy(p);
+                     } });
+}
+
+int main()
+{
+    std::cerr << "sizeof(Variant<Id, Name>) = " << sizeof(Branch) << "\n";
+
+    bench::Reporter reporter;
+    run<Branch>(reporter, "/branch", &copy_branch, &equal_branch, &destroy_branch);
+    run<Table>(reporter, "/table", &copy_table, &equal_table, &destroy_table);
+    reporter.print_json(std::cout);
+    return 0;
+}
@@ -0,0 +1,109 @@
+// 分块流压缩基准：压缩率与编码 / 解码吞吐量。
+//     g++ -std=c++17 -O2 -I.. stream_compress.cpp -o stream_compress && ./stream_compress
+
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "bench.hpp"
+#include "variant_stream.hpp"
+
+struct Tick
+{
+    int64_t timestamp;
+    double price;
+    int32_t volume;
+    int32_t venue;
+};
+
+struct Quote
+{
+    int64_t timestamp;
+    double bid;
+    double ask;
+};
+
+struct Heartbeat
+{
+};
+
+using Event = Variant<Tick, Quote, Heartbeat>;
+
+int main()
+{
+    constexpr size_t count = 1 << 22;
+
+    // 同类事件成串出现，时间戳单调递增，价格小幅波动
+    std::mt19937_64 rng(42);
+    std::vector<Event> events;
+    events.reserve(count);
+    int64_t timestamp = 1700000000000;
+    double price = 100.0;
+    while (events.size() < count)
+    {
+        auto kind = rng() % 8;
+        auto run = 1 + rng() % 64;
+        for (size_t i = 0; i < run && events.size() < count; ++i)
+        {
+            timestamp += 1 + rng() % 4;
+            if (rng() % 4 == 0)
+                price += (static_cast<int>(rng() % 3) - 1) * 0.25;
+            if (kind < 5)
+                events.emplace_back(Tick{timestamp, price, static_cast<int32_t>(100 * (1 + rng() % 4)), 7});
+            else if (kind < 7)
+                events.emplace_back(Quote{timestamp, price - 0.25, price + 0.25});
+            else
+                events.emplace_back(Heartbeat{});
+        }
+    }
+
+    std::vector<char> encoded;
+    {
+        variant_utils::VariantStreamEncoder<Tick, Quote, Heartbeat> encoder(encoded);
+        for (const auto &e : events)
+            encoder.push(e);
+    }
+
+    size_t serialized = 0;
+    for (const auto &e : events)
+        serialized += variant_utils::serialized_size(e);
+    const double raw = static_cast<double>(count * sizeof(Event));
+    std::cerr << "in memory:  " << count * sizeof(Event) << " bytes\n"
+              << "serialized: " << serialized << " bytes\n"
+              << "compressed: " << encoded.size() << " bytes (" << raw / encoded.size() << "x vs memory, "
+              << static_cast<double>(serialized) / encoded.size() << "x vs serialized)\n";
+
+    bench::Reporter reporter;
+    reporter.run("encode", count, [&]
+                 {
+                     std::vector<char> out;
+                     out.reserve(encoded.size());
+                     variant_utils::VariantStreamEncoder<Tick, Quote, Heartbeat> encoder(out);
+                     for (const auto &e : events)
+                         encoder.push(e);
+                     encoder.flush();
+                     bench::do_not_optimize(out.data()); });
+
+    std::vector<Event> decoded;
+    decoded.reserve(count);
+    const auto &decode = reporter.run("decode", count, [&]
+                                      {
+                                          decoded.clear();
+                                          variant_utils::decode_stream(encoded.data(), encoded.data() + encoded.size(), decoded);
+                                          bench::do_not_optimize(decoded.data()); });
+    std::cerr << "decode: " << raw / decode.seconds / 1e9 << " GB/s of in-memory events\n";
+
+    bool same = decoded.size() == count;
+    for (size_t i = 0; same && i < count; ++i)
+        same = decoded[i].index() == events[i].index() &&
+               decoded[i].visit([&](const auto &value)
+                                { return std::memcmp(&value, &events[i].get<std::decay_t<decltype(value)>>(), sizeof(value)) == 0; });
+    if (!same)
+    {
+        std::cerr << "round trip mismatch\n";
+        return 1;
+    }
+
+    reporter.print_json(std::cout);
+    return 0;
+}
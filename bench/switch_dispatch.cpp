@@ -0,0 +1,144 @@
+// 16 个备选类型的 Variant：函数指针表分发（默认）与 switch 分发（switch_policy）的对比。
+//     g++ -std=c++17 -O2 -I.. switch_dispatch.cpp -o switch_dispatch && ./switch_dispatch
+// "known_copy" 在 holds_alternative 之后拷贝：switch 分发时下标已知，拷贝可以被常量传播成一次直接调用。
+
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "bench.hpp"
+#include "variant.hpp"
+
+template <int N>
+struct Small
+{
+    int64_t value;
+
+    bool operator==(const Small &other) const { return value == other.value; }
+};
+
+template <int N>
+struct Text
+{
+    std::string value;
+
+    bool operator==(const Text &other) const { return value == other.value; }
+};
+
+using TableVariant = Variant<Small<0>, Small<1>, Small<2>, Small<3>, Small<4>, Small<5>, Small<6>, Text<7>,
+                             Small<8>, Small<9>, Small<10>, Small<11>, Small<12>, Small<13>, Small<14>, Text<15>>;
+// 同一组备选类型，只在这里改用 switch 分发
+using SwitchVariant = variant_utils::with_policy_t<variant_utils::switch_policy<variant_utils::default_variant_policy>, TableVariant>;
+
+static_assert(SwitchVariant::policy::dispatch == variant_utils::dispatch_backend::switch_case);
+static_assert(TableVariant::policy::dispatch == variant_utils::dispatch_backend::table);
+
+#define NOINLINE __attribute__((noinline))
+
+template <typename V>
+NOINLINE V copy(const V &v) { return v; }
+
+template <typename V>
+NOINLINE bool equal(const V &a, const V &b) { return a == b; }
+
+template <typename V>
+NOINLINE void destroy(V *v) { v->~V(); }
+
+template <typename V>
+NOINLINE size_t visit_sum(const std::vector<V> &values)
+{
+    size_t sum = 0;
+    for (const auto &v : values)
+        sum += v.visit([](const auto &alternative) -> size_t
+                       {
+                           if constexpr (std::is_integral_v<std::decay_t<decltype(alternative.value)>>)
+                               return static_cast<size_t>(alternative.value);
+                           else
+                               return alternative.value.size(); });
+    return sum;
+}
+
+template <typename V>
+NOINLINE size_t known_copy(const std::vector<V> &values)
+{
+    size_t sum = 0;
+    for (const auto &v : values)
+    {
+        if (v.template holds_alternative<Small<3>>())
+        {
+            V c = v;
+            // 让拷贝结果落到内存里再读：拷贝不会被整个省掉，GCC 也不再误报 c 未初始化
+            bench::do_not_optimize(c);
+            sum += static_cast<size_t>(c.template get<3>().value);
+        }
+    }
+    return sum;
+}
+
+template <typename V, size_t I = 0>
+void emplace_nth(std::vector<V> &values, size_t n, int64_t value)
+{
+    if constexpr (I < 16)
+    {
+        if (n != I)
+            return emplace_nth<V, I + 1>(values, n, value);
+        if constexpr (I == 7 || I == 15)
+            values.emplace_back(Text<I>{"t" + std::to_string(value % 100)});
+        else
+            values.emplace_back(Small<I>{value});
+    }
+}
+
+template <typename V>
+void run(bench::Reporter &reporter, const std::string &suffix)
+{
+    constexpr size_t count = 1 << 20;
+
+    std::mt19937 rng(42);
+    std::vector<V> values;
+    values.reserve(count);
+    for (size_t i = 0; i < count; ++i)
+        emplace_nth<V>(values, rng() % 16, static_cast<int64_t>(i));
+
+    std::vector<V> copies;
+    copies.reserve(count);
+    reporter.run("copy" + suffix, count, [&]
+                 {
+                     copies.clear();
+                     for (const auto &v : values)
+                         copies.push_back(copy(v));
+                     bench::do_not_optimize(copies.data()); });
+
+    reporter.run("compare" + suffix, count, [&]
+                 {
+                     size_t same = 0;
+                     for (size_t i = 0; i < count; ++i)
+                         same += equal(values[i], copies[i]);
+                     bench::do_not_optimize(same); });
+
+    reporter.run("visit" + suffix, count, [&]
+                 { bench::do_not_optimize(visit_sum(values)); });
+
+    reporter.run("known_copy" + suffix, count, [&]
+                 { bench::do_not_optimize(known_copy(values)); });
+
+    reporter.run("copy_destroy" + suffix, count, [&]
+                 {
+                     alignas(V) unsigned char buffer[sizeof(V)];
+                     for (const auto &v : values)
+                     {
+                         auto *p = new (buffer) V(v);
+                         bench::do_not_optimize(*p);
+                         destroy(p);
+                     } });
+}
+
+int main()
+{
+    bench::Reporter reporter;
+    run<TableVariant>(reporter, "/table");
+    run<SwitchVariant>(reporter, "/switch");
+    reporter.print_json(std::cout);
+    return 0;
+}
@@ -0,0 +1,220 @@
+// 以 Variant 表示指令的小型栈式解释器：每条指令一次 visit 的循环，与 switch_execute / threaded_execute 的对比。
+//     g++ -std=c++17 -O2 -I.. threaded_interp.cpp -o threaded_interp && ./threaded_interp
+
+#include <iostream>
+#include <vector>
+
+#include "bench.hpp"
+#include "variant_exec.hpp"
+
+struct Push
+{
+    int64_t value;
+    bool operator==(const Push &other) const { return value == other.value; }
+};
+
+struct Load
+{
+    uint32_t slot;
+    bool operator==(const Load &other) const { return slot == other.slot; }
+};
+
+struct Store
+{
+    uint32_t slot;
+    bool operator==(const Store &other) const { return slot == other.slot; }
+};
+
+struct Add
+{
+    bool operator==(const Add &) const { return true; }
+};
+
+struct Sub
+{
+    bool operator==(const Sub &) const { return true; }
+};
+
+struct Mul
+{
+    bool operator==(const Mul &) const { return true; }
+};
+
+struct Less
+{
+    bool operator==(const Less &) const { return true; }
+};
+
+struct JumpIf
+{
+    uint32_t target;
+    bool operator==(const JumpIf &other) const { return target == other.target; }
+};
+
+struct Jump
+{
+    uint32_t target;
+    bool operator==(const Jump &other) const { return target == other.target; }
+};
+
+struct Halt
+{
+    bool operator==(const Halt &) const { return true; }
+};
+
+using Instruction = Variant<Push, Load, Store, Add, Sub, Mul, Less, JumpIf, Jump, Halt>;
+
+struct Machine
+{
+    int64_t stack[64];
+    int64_t *top = stack;
+    int64_t locals[8]{};
+    uint64_t executed = 0;
+    size_t halt_at = 0;
+
+    int64_t pop() { return *--top; }
+    void push(int64_t value) { *top++ = value; }
+
+    size_t operator()(const Push &op, size_t pc)
+    {
+        ++executed;
+        push(op.value);
+        return pc + 1;
+    }
+
+    size_t operator()(const Load &op, size_t pc)
+    {
+        ++executed;
+        push(locals[op.slot]);
+        return pc + 1;
+    }
+
+    size_t operator()(const Store &op, size_t pc)
+    {
+        ++executed;
+        locals[op.slot] = pop();
+        return pc + 1;
+    }
+
+    size_t operator()(const Add &, size_t pc)
+    {
+        ++executed;
+        auto b = pop();
+        top[-1] += b;
+        return pc + 1;
+    }
+
+    size_t operator()(const Sub &, size_t pc)
+    {
+        ++executed;
+        auto b = pop();
+        top[-1] -= b;
+        return pc + 1;
+    }
+
+    size_t operator()(const Mul &, size_t pc)
+    {
+        ++executed;
+        auto b = pop();
+        top[-1] *= b;
+        return pc + 1;
+    }
+
+    size_t operator()(const Less &, size_t pc)
+    {
+        ++executed;
+        auto b = pop();
+        top[-1] = top[-1] < b;
+        return pc + 1;
+    }
+
+    size_t operator()(const JumpIf &op, size_t pc)
+    {
+        ++executed;
+        return pop() ? op.target : pc + 1;
+    }
+
+    size_t operator()(const Jump &op, size_t)
+    {
+        ++executed;
+        return op.target;
+    }
+
+    size_t operator()(const Halt &, size_t)
+    {
+        ++executed;
+        return halt_at;
+    }
+};
+
+// sum = 0; for (i = 0; i < n; ++i) sum = sum + i * 3 - 1;
+std::vector<Instruction> make_program(int64_t n)
+{
+    return {
+        Push{0}, Store{0},                                             // 0: sum = 0
+        Push{0}, Store{1},                                             // 2: i = 0
+        Load{1}, Push{n}, Less{}, JumpIf{10}, Jump{9}, Halt{},         // 4: if (i < n) goto 10 else halt
+        Load{0}, Load{1}, Push{3}, Mul{}, Add{}, Push{1}, Sub{}, Store{0}, // 10: sum = sum + i * 3 - 1
+        Load{1}, Push{1}, Add{}, Store{1},                             // 18: ++i
+        Jump{4}};                                                      // 22: 回到循环头
+}
+
+#define NOINLINE __attribute__((noinline))
+
+NOINLINE int64_t run_visit(const std::vector<Instruction> &code, Machine &m)
+{
+    size_t pc = 0;
+    while (pc < code.size())
+        pc = code[pc].visit([&](const auto &op)
+                            { return m(op, pc); });
+    return m.locals[0];
+}
+
+NOINLINE int64_t run_switch(const std::vector<Instruction> &code, Machine &m)
+{
+    variant_utils::switch_execute(code, m);
+    return m.locals[0];
+}
+
+NOINLINE int64_t run_threaded(const std::vector<Instruction> &code, Machine &m)
+{
+    variant_utils::threaded_execute(code, m);
+    return m.locals[0];
+}
+
+int main()
+{
+    constexpr int64_t n = 1 << 20;
+    auto code = make_program(n);
+
+    int64_t expected = 0;
+    for (int64_t i = 0; i < n; ++i)
+        expected = expected + i * 3 - 1;
+
+    Machine probe;
+    probe.halt_at = code.size();
+    if (run_visit(code, probe) != expected)
+    {
+        std::cerr << "interpreter produced a wrong result\n";
+        return 1;
+    }
+    auto instructions = probe.executed;
+
+    bench::Reporter reporter;
+    auto run = [&](const char *name, int64_t (*interpret)(const std::vector<Instruction> &, Machine &))
+    {
+        reporter.run(name, instructions, [&]
+                     {
+                         Machine m;
+                         m.halt_at = code.size();
+                         auto result = interpret(code, m);
+                         if (result != expected || m.executed != instructions)
+                             std::cerr << name << ": wrong result\n";
+                         bench::do_not_optimize(result); });
+    };
+    run("interp/visit", &run_visit);
+    run("interp/switch", &run_switch);
+    run("interp/threaded", &run_threaded);
+    reporter.print_json(std::cout);
+    return 0;
+}
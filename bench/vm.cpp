@@ -0,0 +1,619 @@
+// 小型栈式虚拟机：指令与值都是 Variant 的实现，与等价的虚函数实现（指令、值都是类层次）的对比。
+// 三个负载：递归 fib、计数循环、混合整数 / 布尔运算；输出每秒执行的指令数、每条 VM 指令的分支预测失败次数，
+// 以及分支预测失败率（失败次数 / CPU 执行的分支数）。
+// 虚函数实现中的值是堆上的对象，每次 Push / Load / 运算都会 clone 或 make_unique，这也是类层次写法的主要开销。
+//     g++ -std=c++17 -O2 -I.. vm.cpp -o vm && ./vm
+
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "bench.hpp"
+#include "variant_exec.hpp"
+
+// ---------------------------------------------------------------- Variant 实现
+
+using Value = Variant<int64_t, bool>;
+
+namespace ops
+{
+    struct Push
+    {
+        Value value;
+        bool operator==(const Push &other) const { return value == other.value; }
+    };
+
+    // 读取 / 写入当前栈帧中的第 slot 个槽位
+    struct Load
+    {
+        uint32_t slot;
+        bool operator==(const Load &other) const { return slot == other.slot; }
+    };
+
+    struct Store
+    {
+        uint32_t slot;
+        bool operator==(const Store &other) const { return slot == other.slot; }
+    };
+
+    struct Add
+    {
+        bool operator==(const Add &) const { return true; }
+    };
+
+    struct Sub
+    {
+        bool operator==(const Sub &) const { return true; }
+    };
+
+    struct Mul
+    {
+        bool operator==(const Mul &) const { return true; }
+    };
+
+    struct Less
+    {
+        bool operator==(const Less &) const { return true; }
+    };
+
+    // 比较任意两个值，类型不同时不相等
+    struct Equal
+    {
+        bool operator==(const Equal &) const { return true; }
+    };
+
+    struct JumpIfFalse
+    {
+        uint32_t target;
+        bool operator==(const JumpIfFalse &other) const { return target == other.target; }
+    };
+
+    struct Jump
+    {
+        uint32_t target;
+        bool operator==(const Jump &other) const { return target == other.target; }
+    };
+
+    // 栈顶的 argc 个值成为被调函数栈帧的前 argc 个槽位
+    struct Call
+    {
+        uint32_t target;
+        uint32_t argc;
+        bool operator==(const Call &other) const { return target == other.target && argc == other.argc; }
+    };
+
+    struct Ret
+    {
+        bool operator==(const Ret &) const { return true; }
+    };
+
+    struct Halt
+    {
+        bool operator==(const Halt &) const { return true; }
+    };
+}
+
+using Instruction = Variant<ops::Push, ops::Load, ops::Store, ops::Add, ops::Sub, ops::Mul, ops::Less, ops::Equal,
+                            ops::JumpIfFalse, ops::Jump, ops::Call, ops::Ret, ops::Halt>;
+
+// 整数运算按无符号数回绕，避免有符号溢出
+inline int64_t wrap_add(int64_t a, int64_t b) { return static_cast<int64_t>(static_cast<uint64_t>(a) + static_cast<uint64_t>(b)); }
+inline int64_t wrap_sub(int64_t a, int64_t b) { return static_cast<int64_t>(static_cast<uint64_t>(a) - static_cast<uint64_t>(b)); }
+inline int64_t wrap_mul(int64_t a, int64_t b) { return static_cast<int64_t>(static_cast<uint64_t>(a) * static_cast<uint64_t>(b)); }
+
+struct VariantMachine
+{
+    struct frame
+    {
+        size_t return_pc;
+        size_t base;
+    };
+
+    std::vector<Value> stack;
+    std::vector<frame> frames;
+    size_t base = 0;
+    size_t end = 0;
+    uint64_t executed = 0;
+
+    explicit VariantMachine(size_t code_size) : end(code_size)
+    {
+        stack.reserve(1024);
+        frames.reserve(256);
+    }
+
+    Value pop()
+    {
+        Value value = std::move(stack.back());
+        stack.pop_back();
+        return value;
+    }
+
+    template <typename F>
+    size_t binary(size_t pc, F &&f)
+    {
+        ++executed;
+        auto b = pop();
+        auto &a = stack.back();
+        a = Value(f(a.get<int64_t>(), b.get<int64_t>()));
+        return pc + 1;
+    }
+
+    size_t operator()(const ops::Push &op, size_t pc)
+    {
+        ++executed;
+        stack.push_back(op.value);
+        return pc + 1;
+    }
+
+    size_t operator()(const ops::Load &op, size_t pc)
+    {
+        ++executed;
+        stack.push_back(stack[base + op.slot]);
+        return pc + 1;
+    }
+
+    size_t operator()(const ops::Store &op, size_t pc)
+    {
+        ++executed;
+        stack[base + op.slot] = pop();
+        return pc + 1;
+    }
+
+    size_t operator()(const ops::Add &, size_t pc) { return binary(pc, wrap_add); }
+    size_t operator()(const ops::Sub &, size_t pc) { return binary(pc, wrap_sub); }
+    size_t operator()(const ops::Mul &, size_t pc) { return binary(pc, wrap_mul); }
+
+    size_t operator()(const ops::Less &, size_t pc)
+    {
+        ++executed;
+        auto b = pop();
+        auto &a = stack.back();
+        a = Value(a.get<int64_t>() < b.get<int64_t>());
+        return pc + 1;
+    }
+
+    size_t operator()(const ops::Equal &, size_t pc)
+    {
+        ++executed;
+        auto b = pop();
+        auto &a = stack.back();
+        a = Value(a == b);
+        return pc + 1;
+    }
+
+    size_t operator()(const ops::JumpIfFalse &op, size_t pc)
+    {
+        ++executed;
+        return pop().get<bool>() ? pc + 1 : op.target;
+    }
+
+    size_t operator()(const ops::Jump &op, size_t)
+    {
+        ++executed;
+        return op.target;
+    }
+
+    size_t operator()(const ops::Call &op, size_t pc)
+    {
+        ++executed;
+        frames.push_back({pc + 1, base});
+        base = stack.size() - op.argc;
+        return op.target;
+    }
+
+    size_t operator()(const ops::Ret &, size_t)
+    {
+        ++executed;
+        auto result = pop();
+        stack.resize(base);
+        stack.push_back(std::move(result));
+        auto caller = frames.back();
+        frames.pop_back();
+        base = caller.base;
+        return caller.return_pc;
+    }
+
+    size_t operator()(const ops::Halt &, size_t)
+    {
+        ++executed;
+        return end;
+    }
+};
+
+// ---------------------------------------------------------------- 虚函数实现
+
+struct Object
+{
+    virtual ~Object() = default;
+    virtual std::unique_ptr<Object> clone() const = 0;
+    virtual int64_t as_int() const = 0;
+    virtual bool as_bool() const = 0;
+    virtual bool equals(const Object &other) const = 0;
+};
+
+struct IntObject final : Object
+{
+    int64_t value;
+    explicit IntObject(int64_t v) : value(v) {}
+    std::unique_ptr<Object> clone() const override { return std::make_unique<IntObject>(value); }
+    int64_t as_int() const override { return value; }
+    bool as_bool() const override { return value != 0; }
+    bool equals(const Object &other) const override
+    {
+        auto *o = dynamic_cast<const IntObject *>(&other);
+        return o && o->value == value;
+    }
+};
+
+struct BoolObject final : Object
+{
+    bool value;
+    explicit BoolObject(bool v) : value(v) {}
+    std::unique_ptr<Object> clone() const override { return std::make_unique<BoolObject>(value); }
+    int64_t as_int() const override { return value; }
+    bool as_bool() const override { return value; }
+    bool equals(const Object &other) const override
+    {
+        auto *o = dynamic_cast<const BoolObject *>(&other);
+        return o && o->value == value;
+    }
+};
+
+struct VirtualMachine;
+
+struct Node
+{
+    virtual ~Node() = default;
+    virtual size_t execute(VirtualMachine &vm, size_t pc) const = 0;
+};
+
+struct VirtualMachine
+{
+    struct frame
+    {
+        size_t return_pc;
+        size_t base;
+    };
+
+    std::vector<std::unique_ptr<Object>> stack;
+    std::vector<frame> frames;
+    size_t base = 0;
+    size_t end = 0;
+    uint64_t executed = 0;
+
+    explicit VirtualMachine(size_t code_size) : end(code_size)
+    {
+        stack.reserve(1024);
+        frames.reserve(256);
+    }
+
+    std::unique_ptr<Object> pop()
+    {
+        auto value = std::move(stack.back());
+        stack.pop_back();
+        return value;
+    }
+
+    void run(const std::vector<std::unique_ptr<Node>> &code)
+    {
+        size_t pc = 0;
+        while (pc < code.size())
+            pc = code[pc]->execute(*this, pc);
+    }
+};
+
+namespace nodes
+{
+    struct Push final : Node
+    {
+        std::unique_ptr<Object> value;
+        explicit Push(std::unique_ptr<Object> v) : value(std::move(v)) {}
+        size_t execute(VirtualMachine &vm, size_t pc) const override
+        {
+            ++vm.executed;
+            vm.stack.push_back(value->clone());
+            return pc + 1;
+        }
+    };
+
+    struct Load final : Node
+    {
+        uint32_t slot;
+        explicit Load(uint32_t s) : slot(s) {}
+        size_t execute(VirtualMachine &vm, size_t pc) const override
+        {
+            ++vm.executed;
+            vm.stack.push_back(vm.stack[vm.base + slot]->clone());
+            return pc + 1;
+        }
+    };
+
+    struct Store final : Node
+    {
+        uint32_t slot;
+        explicit Store(uint32_t s) : slot(s) {}
+        size_t execute(VirtualMachine &vm, size_t pc) const override
+        {
+            ++vm.executed;
+            vm.stack[vm.base + slot] = vm.pop();
+            return pc + 1;
+        }
+    };
+
+    template <int64_t (*Op)(int64_t, int64_t)>
+    struct Binary final : Node
+    {
+        size_t execute(VirtualMachine &vm, size_t pc) const override
+        {
+            ++vm.executed;
+            auto b = vm.pop();
+            auto &a = vm.stack.back();
+            a = std::make_unique<IntObject>(Op(a->as_int(), b->as_int()));
+            return pc + 1;
+        }
+    };
+
+    struct Less final : Node
+    {
+        size_t execute(VirtualMachine &vm, size_t pc) const override
+        {
+            ++vm.executed;
+            auto b = vm.pop();
+            auto &a = vm.stack.back();
+            a = std::make_unique<BoolObject>(a->as_int() < b->as_int());
+            return pc + 1;
+        }
+    };
+
+    struct Equal final : Node
+    {
+        size_t execute(VirtualMachine &vm, size_t pc) const override
+        {
+            ++vm.executed;
+            auto b = vm.pop();
+            auto &a = vm.stack.back();
+            a = std::make_unique<BoolObject>(a->equals(*b));
+            return pc + 1;
+        }
+    };
+
+    struct JumpIfFalse final : Node
+    {
+        uint32_t target;
+        explicit JumpIfFalse(uint32_t t) : target(t) {}
+        size_t execute(VirtualMachine &vm, size_t pc) const override
+        {
+            ++vm.executed;
+            return vm.pop()->as_bool() ? pc + 1 : target;
+        }
+    };
+
+    struct Jump final : Node
+    {
+        uint32_t target;
+        explicit Jump(uint32_t t) : target(t) {}
+        size_t execute(VirtualMachine &vm, size_t) const override
+        {
+            ++vm.executed;
+            return target;
+        }
+    };
+
+    struct Call final : Node
+    {
+        uint32_t target, argc;
+        Call(uint32_t t, uint32_t a) : target(t), argc(a) {}
+        size_t execute(VirtualMachine &vm, size_t pc) const override
+        {
+            ++vm.executed;
+            vm.frames.push_back({pc + 1, vm.base});
+            vm.base = vm.stack.size() - argc;
+            return target;
+        }
+    };
+
+    struct Ret final : Node
+    {
+        size_t execute(VirtualMachine &vm, size_t) const override
+        {
+            ++vm.executed;
+            auto result = vm.pop();
+            vm.stack.resize(vm.base);
+            vm.stack.push_back(std::move(result));
+            auto caller = vm.frames.back();
+            vm.frames.pop_back();
+            vm.base = caller.base;
+            return caller.return_pc;
+        }
+    };
+
+    struct Halt final : Node
+    {
+        size_t execute(VirtualMachine &vm, size_t) const override
+        {
+            ++vm.executed;
+            return vm.end;
+        }
+    };
+}
+
+// 把 Variant 指令翻译成等价的虚函数节点，保证两种实现执行的是同一段程序
+struct to_node
+{
+    std::unique_ptr<Node> operator()(const ops::Push &op) const
+    {
+        if (op.value.holds_alternative<bool>())
+            return std::make_unique<nodes::Push>(std::make_unique<BoolObject>(op.value.get<bool>()));
+        return std::make_unique<nodes::Push>(std::make_unique<IntObject>(op.value.get<int64_t>()));
+    }
+    std::unique_ptr<Node> operator()(const ops::Load &op) const { return std::make_unique<nodes::Load>(op.slot); }
+    std::unique_ptr<Node> operator()(const ops::Store &op) const { return std::make_unique<nodes::Store>(op.slot); }
+    std::unique_ptr<Node> operator()(const ops::Add &) const { return std::make_unique<nodes::Binary<wrap_add>>(); }
+    std::unique_ptr<Node> operator()(const ops::Sub &) const { return std::make_unique<nodes::Binary<wrap_sub>>(); }
+    std::unique_ptr<Node> operator()(const ops::Mul &) const { return std::make_unique<nodes::Binary<wrap_mul>>(); }
+    std::unique_ptr<Node> operator()(const ops::Less &) const { return std::make_unique<nodes::Less>(); }
+    std::unique_ptr<Node> operator()(const ops::Equal &) const { return std::make_unique<nodes::Equal>(); }
+    std::unique_ptr<Node> operator()(const ops::JumpIfFalse &op) const { return std::make_unique<nodes::JumpIfFalse>(op.target); }
+    std::unique_ptr<Node> operator()(const ops::Jump &op) const { return std::make_unique<nodes::Jump>(op.target); }
+    std::unique_ptr<Node> operator()(const ops::Call &op) const { return std::make_unique<nodes::Call>(op.target, op.argc); }
+    std::unique_ptr<Node> operator()(const ops::Ret &) const { return std::make_unique<nodes::Ret>(); }
+    std::unique_ptr<Node> operator()(const ops::Halt &) const { return std::make_unique<nodes::Halt>(); }
+};
+
+// ---------------------------------------------------------------- 负载
+
+using namespace ops;
+
+struct Workload
+{
+    std::string name;
+    std::vector<Instruction> code;
+    int64_t expected;
+};
+
+// fib(n)，递归调用
+Workload make_fib(int64_t n)
+{
+    std::vector<Instruction> code{
+        Push{Value(n)}, Call{3, 1}, Halt{},                  // 0: fib(n)
+        Load{0}, Push{Value(int64_t{2})}, Less{},            // 3: if (n < 2)
+        JumpIfFalse{9}, Load{0}, Ret{},                      // 6:     return n
+        Load{0}, Push{Value(int64_t{1})}, Sub{}, Call{3, 1}, // 9: fib(n - 1)
+        Load{0}, Push{Value(int64_t{2})}, Sub{}, Call{3, 1}, // 13: fib(n - 2)
+        Add{}, Ret{}};                                       // 17
+    int64_t a = 0, b = 1;
+    for (int64_t i = 0; i < n; ++i)
+        a = std::exchange(b, a + b);
+    return {"fib", std::move(code), a};
+}
+
+// sum = 0; for (i = 0; i < n; ++i) sum += i;
+Workload make_loop(int64_t n)
+{
+    std::vector<Instruction> code{
+        Push{Value(int64_t{0})}, Push{Value(int64_t{0})},      // 0: 槽位 0 = sum，槽位 1 = i
+        Load{1}, Push{Value(n)}, Less{}, JumpIfFalse{15},      // 2: while (i < n)
+        Load{0}, Load{1}, Add{}, Store{0},                     // 6:     sum += i
+        Load{1}, Push{Value(int64_t{1})}, Add{}, Store{1},     // 10:    ++i
+        Jump{2},                                               // 14
+        Load{0}, Halt{}};                                      // 15
+    int64_t sum = 0;
+    for (int64_t i = 0; i < n; ++i)
+        sum += i;
+    return {"loop", std::move(code), sum};
+}
+
+// 整数与布尔混合：acc = acc * 31 + i - i * i；若 (acc < i) == (i < 1000) 则 ++hits
+Workload make_arith(int64_t n)
+{
+    std::vector<Instruction> code{
+        Push{Value(int64_t{0})}, Push{Value(int64_t{0})}, Push{Value(int64_t{0})}, // 0: 槽位 0 = acc，1 = i，2 = hits
+        Load{1}, Push{Value(n)}, Less{}, JumpIfFalse{34},                         // 3: while (i < n)
+        Load{0}, Push{Value(int64_t{31})}, Mul{}, Load{1}, Add{},                 // 7:     acc * 31 + i
+        Load{1}, Load{1}, Mul{}, Sub{}, Store{0},                                 // 12:    - i * i
+        Load{0}, Load{1}, Less{},                                                 // 17:    if ((acc < i)
+        Load{1}, Push{Value(int64_t{1000})}, Less{}, Equal{}, JumpIfFalse{29},    // 20:        == (i < 1000))
+        Load{2}, Push{Value(int64_t{1})}, Add{}, Store{2},                        // 25:        ++hits
+        Load{1}, Push{Value(int64_t{1})}, Add{}, Store{1},                        // 29:    ++i
+        Jump{3},                                                                  // 33
+        Load{2}, Halt{}};                                                         // 34
+    int64_t acc = 0, hits = 0;
+    for (int64_t i = 0; i < n; ++i)
+    {
+        acc = wrap_sub(wrap_add(wrap_mul(acc, 31), i), wrap_mul(i, i));
+        hits += (acc < i) == (i < 1000);
+    }
+    return {"arith", std::move(code), hits};
+}
+
+#define NOINLINE __attribute__((noinline))
+
+NOINLINE Value run_visit(const std::vector<Instruction> &code, VariantMachine &m)
+{
+    size_t pc = 0;
+    while (pc < code.size())
+        pc = code[pc].visit([&](const auto &op)
+                            { return m(op, pc); });
+    return m.stack.back();
+}
+
+NOINLINE Value run_threaded(const std::vector<Instruction> &code, VariantMachine &m)
+{
+    variant_utils::threaded_execute(code, m);
+    return m.stack.back();
+}
+
+NOINLINE int64_t run_virtual(const std::vector<std::unique_ptr<Node>> &code, VirtualMachine &m)
+{
+    m.run(code);
+    return m.stack.back()->as_int();
+}
+
+int main()
+{
+    std::vector<Workload> workloads{make_fib(25), make_loop(1 << 20), make_arith(1 << 20)};
+
+    bench::Reporter reporter;
+    std::vector<bench::Result> results;
+    for (auto &w : workloads)
+    {
+        std::vector<std::unique_ptr<Node>> nodes;
+        for (const auto &ins : w.code)
+            nodes.push_back(ins.visit(to_node{}));
+
+        VariantMachine probe(w.code.size());
+        auto result = run_visit(w.code, probe);
+        VariantMachine tprobe(w.code.size());
+        auto tresult = run_threaded(w.code, tprobe);
+        VirtualMachine vprobe(nodes.size());
+        auto vresult = run_virtual(nodes, vprobe);
+        if (!(result == Value(w.expected)))
+        {
+            std::cerr << w.name << ": wrong result\n";
+            return 1;
+        }
+        if (!(result == tresult) || !(result == Value(vresult)) ||
+            probe.executed != tprobe.executed || probe.executed != vprobe.executed)
+        {
+            std::cerr << w.name << ": implementations disagree\n";
+            return 1;
+        }
+        auto instructions = probe.executed;
+
+        auto record = [&](const bench::Result &r)
+        { results.push_back(r); };
+
+        record(reporter.run(w.name + "/variant_visit", instructions, [&]
+                            {
+                                VariantMachine m(w.code.size());
+                                bench::do_not_optimize(run_visit(w.code, m)); }));
+        record(reporter.run(w.name + "/variant_threaded", instructions, [&]
+                            {
+                                VariantMachine m(w.code.size());
+                                bench::do_not_optimize(run_threaded(w.code, m)); }));
+        record(reporter.run(w.name + "/virtual", instructions, [&]
+                            {
+                                VirtualMachine m(nodes.size());
+                                bench::do_not_optimize(run_virtual(nodes, m)); }));
+    }
+
+    // 分支预测失败需要硬件计数器（见 bench.hpp）；per_op 按 VM 指令平均
+    for (const auto &r : results)
+    {
+        std::cerr << std::left << std::setw(24) << r.name << std::right << std::fixed << std::setprecision(1)
+                  << std::setw(10) << r.ops / r.seconds / 1e6 << " M instructions/s";
+        auto misses = r.per_op("branch_misses");
+        if (misses >= 0)
+            std::cerr << std::setw(10) << std::setprecision(3) << misses << " branch misses/instruction";
+        if (auto branches = r.per_op("branches"); misses >= 0 && branches > 0)
+            std::cerr << std::setw(10) << std::setprecision(2) << misses / branches * 100 << "% branch miss rate";
+        std::cerr << "\n";
+    }
+    if (!reporter.counters_available())
+        std::cerr << "hardware counters unavailable, branch misses not reported\n";
+    reporter.print_json(std::cout);
+    return 0;
+}
@@ -1,8 +1,54 @@
 // main.cpp
 #include <iostream>
 #include <string>
+#include <vector>
 #include <cassert>
+#include <stdexcept>
+#include <cstdio>
+#include <array>
+#include <thread>
+#include <limits>
+#include <sstream>
+#include <string_view>
+#include <utility>
 #include "variant.hpp" // Your header file
+#include "variant_result.hpp"
+#include "variant_stream.hpp"
+#include "variant_column.hpp"
+#if __has_include(<sys/mman.h>)
+#include "variant_column_file.hpp"
+#define VARIANT_TEST_COLUMN_FILE
+#endif
+#include "variant_pool.hpp"
+#include "variant_arrow.hpp"
+#include "variant_intern.hpp"
+#include "nan_box_variant.hpp"
+#include "variant_exec.hpp"
+#include "variant_ref.hpp"
+#include "ptr_variant.hpp"
+#include "variant_serialize.hpp"
+#include "variant_cow.hpp"
+
+// Like assert, but the expression is evaluated in NDEBUG builds too; for checks whose call later steps depend on.
+#define VERIFY(expr)                             \
+    do                                           \
+    {                                            \
+        [[maybe_unused]] bool verified = (expr); \
+        assert(verified && #expr);               \
+    } while (0)
+
+// Counts live instances so constructions and destructions can be checked to balance.
+struct Tracked
+{
+    static inline int live = 0;
+    int value = 0;
+    Tracked() { ++live; }
+    Tracked(const Tracked &other) : value(other.value) { ++live; }
+    Tracked(Tracked &&other) noexcept : value(other.value) { ++live; }
+    Tracked &operator=(const Tracked &) = default;
+    ~Tracked() { --live; }
+    bool operator==(const Tracked &other) const { return value == other.value; }
+};
 
 // A helper struct to trace lifecycle events.
 struct Logger
@@ -39,10 +85,23 @@ int main()
     assert(v1.get<0>() == 10);
     assert(v1.holds_alternative<int>());
 
-    Variant<int, std::string, Logger> v2((std::string) "hello");
+    Variant<int, std::string, Logger> v2("hello"); // Converting construction picks std::string
     assert(v2.index() == 1);
     assert(v2.get<std::string>() == "hello");
 
+    std::cout << "\n--- Testing Converting Construction ---\n";
+    {
+        Variant<long, std::string> v(42); // int -> long, no exact match
+        assert(v.index() == 0);
+        v = "world";
+        assert(v.index() == 1);
+        assert(v.get<std::string>() == "world");
+
+        // Narrowing conversions are rejected, and pointers never decay to bool
+        static_assert(!std::is_constructible_v<Variant<int, float>, double>);
+        static_assert(!std::is_constructible_v<Variant<int, bool>, const char *>);
+    }
+
     std::cout << "\n--- Testing Assignment from Value ---\n";
     {
         Variant<int, Logger> v(100);
@@ -81,6 +140,899 @@ int main()
     assert(v6.get<Logger>().id == 3);
     assert(v5.index() == -1);
 
+    std::cout << "\n--- Testing Result Assignment with a Throwing Copy ---\n";
+    {
+        struct ThrowingCopy
+        {
+            int value;
+            bool throw_on_copy;
+            ThrowingCopy(int v, bool t) : value(v), throw_on_copy(t) {}
+            ThrowingCopy(const ThrowingCopy &other) : value(other.value), throw_on_copy(other.throw_on_copy)
+            {
+                if (throw_on_copy)
+                    throw std::runtime_error("copy");
+            }
+            ThrowingCopy(ThrowingCopy &&other) noexcept = default;
+            ThrowingCopy &operator=(const ThrowingCopy &) = default;
+            ThrowingCopy &operator=(ThrowingCopy &&) noexcept = default;
+        };
+
+        // value -> error: the error's copy throws, the value must survive
+        Result<int, ThrowingCopy> r(1);
+        const Result<int, ThrowingCopy> failing(Unexpected(ThrowingCopy(2, true)));
+        bool thrown = false;
+        try
+        {
+            r = failing;
+        }
+        catch (const std::runtime_error &)
+        {
+            thrown = true;
+        }
+        assert(thrown && r.has_value() && r.value() == 1);
+
+        // error -> error with the same throwing copy
+        Result<int, ThrowingCopy> e(Unexpected(ThrowingCopy(3, false)));
+        thrown = false;
+        try
+        {
+            e = failing;
+        }
+        catch (const std::runtime_error &)
+        {
+            thrown = true;
+        }
+        assert(thrown && !e.has_value() && e.error().value == 3);
+
+        // Neither side can be copied without throwing: the old error is restored from a backup
+        struct ThrowingMove
+        {
+            int value;
+            ThrowingMove(int v) : value(v) {}
+            ThrowingMove(const ThrowingMove &) { throw std::runtime_error("copy"); }
+            ThrowingMove(ThrowingMove &&other) noexcept(false) : value(other.value) {}
+            ThrowingMove &operator=(const ThrowingMove &) = default;
+        };
+        Result<ThrowingMove, int> m(Unexpected(5));
+        const Result<ThrowingMove, int> source(ThrowingMove(6));
+        thrown = false;
+        try
+        {
+            m = source;
+        }
+        catch (const std::runtime_error &)
+        {
+            thrown = true;
+        }
+        assert(thrown && !m.has_value() && m.error() == 5);
+
+        // map_error on an rvalue moves the error into f instead of copying it
+        auto mapped = Result<int, ThrowingCopy>(Unexpected(ThrowingCopy(7, true))).map_error([](ThrowingCopy error)
+                                                                                            { return error.value * 2; });
+        assert(!mapped.has_value() && mapped.error() == 14);
+        auto kept = Result<std::string, int>(std::string(64, 'k')).map_error([](int error)
+                                                                             { return error + 1; });
+        assert(kept.has_value() && kept.value() == std::string(64, 'k'));
+    }
+
+    std::cout << "\n--- Testing Stream Compression Round Trip and Corrupt Blocks ---\n";
+    {
+        using V = Variant<int32_t, double>;
+        std::vector<char> bytes;
+        {
+            variant_utils::VariantStreamEncoder<int32_t, double> encoder(bytes, 64);
+            for (int i = 0; i < 1000; ++i)
+            {
+                if (i % 7 == 3)
+                    encoder.push(V());
+                else if (i % 3)
+                    encoder.push(V(int32_t{i}));
+                else
+                    encoder.push(V(i * 0.5));
+            }
+        }
+        std::vector<V> decoded;
+        assert(variant_utils::decode_stream(bytes.data(), bytes.data() + bytes.size(), decoded));
+        assert(decoded.size() == 1000);
+        assert(decoded[3].index() == -1 && decoded[4].get<int32_t>() == 4 && decoded[6].get<double>() == 3.0);
+
+        // Run lengths whose sum wraps around to the row count
+        std::vector<char> wrapping;
+        variant_utils::append_varint(wrapping, 2);
+        variant_utils::append_varint(wrapping, 2);
+        variant_utils::append_varint(wrapping, 0);
+        variant_utils::append_varint(wrapping, ~uint64_t{0});
+        variant_utils::append_varint(wrapping, 0);
+        variant_utils::append_varint(wrapping, 3);
+        variant_utils::append_varint(wrapping, 0);
+        variant_utils::append_varint(wrapping, 0);
+        std::vector<V> out(5);
+        assert(!variant_utils::decode_block(wrapping.data(), wrapping.data() + wrapping.size(), out));
+
+        // A header claiming far more rows than could ever be stored
+        std::vector<char> huge;
+        variant_utils::append_varint(huge, uint64_t{1} << 62);
+        variant_utils::append_varint(huge, 1);
+        variant_utils::append_varint(huge, 0);
+        variant_utils::append_varint(huge, uint64_t{1} << 62);
+        variant_utils::append_varint(huge, 0);
+        variant_utils::append_varint(huge, 0);
+        assert(!variant_utils::decode_block(huge.data(), huge.data() + huge.size(), out));
+
+        // A few bytes of empty rows just past the per-block limit are rejected before anything is allocated
+        std::vector<char> empty_rows;
+        variant_utils::append_varint(empty_rows, variant_utils::stream_max_block_rows + 1);
+        variant_utils::append_varint(empty_rows, 1);
+        variant_utils::append_varint(empty_rows, 0);
+        variant_utils::append_varint(empty_rows, variant_utils::stream_max_block_rows + 1);
+        variant_utils::append_varint(empty_rows, 0);
+        variant_utils::append_varint(empty_rows, 0);
+        assert(!variant_utils::decode_block(empty_rows.data(), empty_rows.data() + empty_rows.size(), out));
+        assert(out.size() == 5 && out.capacity() < variant_utils::stream_max_block_rows);
+
+        // Truncated blocks are rejected rather than read past the end
+        for (size_t cut = 1; cut < 32; ++cut)
+        {
+            std::vector<V> partial;
+            assert(!variant_utils::decode_stream(bytes.data(), bytes.data() + bytes.size() - cut, partial));
+        }
+    }
+
+#ifdef VARIANT_TEST_COLUMN_FILE
+    std::cout << "\n--- Testing Mapped Columns Reject Corrupt Files ---\n";
+    {
+        const char *path = "variant_columns_test.col";
+        variant_utils::VariantColumns<int32_t, double> columns;
+        for (int i = 0; i < 100; ++i)
+        {
+            if (i % 10 == 9)
+                columns.push_back(Variant<int32_t, double>());
+            else if (i % 2)
+                columns.push_back(int32_t{i});
+            else
+                columns.push_back(i * 0.25);
+        }
+        VERIFY(variant_utils::write_columns(path, columns));
+
+        variant_utils::MappedVariantColumns<int32_t, double> mapped;
+        VERIFY(mapped.open(path));
+        assert(mapped.size() == 100 && mapped[1].get<int32_t>() == 1 && mapped[2].get<double>() == 0.5 && mapped[9].index() == -1);
+        assert(mapped.verify());
+        mapped.close();
+
+        // Alternatives of the same size but a different type, or in a different order, are rejected
+        variant_utils::MappedVariantColumns<double, int32_t> swapped;
+        assert(!swapped.open(path));
+        variant_utils::VariantColumns<int32_t, float> floats;
+        floats.push_back(int32_t{1});
+        floats.push_back(2.5f);
+        VERIFY(variant_utils::write_columns(path, floats));
+        variant_utils::MappedVariantColumns<float, int32_t> reordered;
+        assert(!reordered.open(path));
+        variant_utils::MappedVariantColumns<int32_t, float> matching;
+        VERIFY(matching.open(path) && matching[1].get<float>() == 2.5f);
+        matching.close();
+        VERIFY(variant_utils::write_columns(path, columns));
+
+        variant_utils::column_file_header header{};
+        std::FILE *file = std::fopen(path, "rb");
+        VERIFY(file && std::fread(&header, sizeof(header), 1, file) == 1);
+        std::fclose(file);
+
+        auto patch = [&](uint64_t offset, const void *bytes, size_t size)
+        {
+            std::FILE *file = std::fopen(path, "r+b");
+            assert(file);
+            std::fseek(file, static_cast<long>(offset), SEEK_SET);
+            std::fwrite(bytes, 1, size, file);
+            std::fclose(file);
+        };
+
+        // Rows are checked when they are read: a tag beyond the alternatives would index past the row table
+        auto rejects_row_3 = [&]()
+        {
+            bool thrown = false;
+            try
+            {
+                mapped[3];
+            }
+            catch (const std::out_of_range &)
+            {
+                thrown = true;
+            }
+            return thrown;
+        };
+        const int8_t bad_tag = 5;
+        patch(header.tags_offset + 3, &bad_tag, sizeof(bad_tag));
+        VERIFY(mapped.open(path) && !mapped.verify() && rejects_row_3() && mapped[4].get<double>() == 1.0);
+        mapped.close();
+        VERIFY(variant_utils::write_columns(path, columns));
+
+        // An offset beyond the end of its column
+        const int32_t bad_offset = 1000;
+        patch(header.offsets_offset + 3 * sizeof(int32_t), &bad_offset, sizeof(bad_offset));
+        VERIFY(mapped.open(path) && !mapped.verify() && rejects_row_3());
+        mapped.close();
+        std::remove(path);
+    }
+#endif
+
+    std::cout << "\n--- Testing Pooled Boxes Destroyed on Another Thread ---\n";
+    {
+        using Pooled = Variant<int, Box<std::array<int64_t, 6>>>;
+        std::vector<Pooled> batch;
+        VariantPool pool;
+        VariantPoolScope scope(pool);
+        for (int round = 0; round < 50; ++round)
+        {
+            for (int i = 0; i < 2000; ++i)
+                batch.emplace_back(Box<std::array<int64_t, 6>>(std::array<int64_t, 6>{round, i}));
+            // Hand the batch to a worker that destroys it while this thread keeps allocating
+            std::thread worker([moved = std::move(batch)]() mutable
+                               { moved.clear(); });
+            std::vector<Pooled> local;
+            for (int i = 0; i < 2000; ++i)
+                local.emplace_back(Box<std::array<int64_t, 6>>(std::array<int64_t, 6>{i}));
+            assert(local[1999].get<1>()->at(0) == 1999);
+            worker.join();
+            batch.clear();
+        }
+
+        // Objects outliving a reset are released by whichever thread destroys them last
+        std::vector<Pooled> mine, theirs;
+        for (int i = 0; i < 1000; ++i)
+        {
+            mine.emplace_back(Box<std::array<int64_t, 6>>(std::array<int64_t, 6>{i}));
+            theirs.emplace_back(Box<std::array<int64_t, 6>>(std::array<int64_t, 6>{i}));
+        }
+        std::thread worker([moved = std::move(theirs)]() mutable
+                           { moved.clear(); });
+        pool.reset();
+        mine.clear();
+        worker.join();
+    }
+
+    std::cout << "\n--- Testing Arrow Export/Import Round Trip ---\n";
+    {
+        using Columns = variant_utils::VariantColumns<int32_t, double, int64_t>;
+        Columns columns;
+        for (int32_t i = 0; i < 200000; ++i)
+        {
+            if (i % 3 == 0)
+                columns.push_back(Variant<int32_t, double, int64_t>(i));
+            else if (i % 3 == 1)
+                columns.push_back(Variant<int32_t, double, int64_t>(i * 0.5));
+            else
+                columns.push_back(Variant<int32_t, double, int64_t>(int64_t{i} << 32));
+        }
+
+        for (auto mode : {variant_utils::arrow_union_mode::dense, variant_utils::arrow_union_mode::sparse})
+        {
+            ArrowSchema schema;
+            ArrowArray array;
+            VERIFY(variant_utils::export_arrow(columns, &schema, &array, mode));
+            Columns back;
+            VERIFY(variant_utils::import_arrow(&schema, &array, back));
+            assert(back.size() == columns.size());
+            for (int32_t row = 0; row < 200000; row += 997)
+            {
+                assert(back[row].index() == row % 3);
+                if (row % 3 == 0)
+                    assert(back[row].get<int32_t>() == row);
+                else if (row % 3 == 1)
+                    assert(back[row].get<double>() == row * 0.5);
+                else
+                    assert(back[row].get<int64_t>() == int64_t{row} << 32);
+            }
+
+            // A consumer may move a child out and keep it after releasing the parent
+            ArrowArray child = *array.children[1];
+            array.children[1]->release = nullptr;
+            ArrowSchema child_schema = *schema.children[1];
+            schema.children[1]->release = nullptr;
+            array.release(&array);
+            schema.release(&schema);
+            assert(std::string(child_schema.format) == "g" && std::string(child_schema.name) == "1");
+            const double *values = static_cast<const double *>(child.buffers[1]);
+            assert(values[mode == variant_utils::arrow_union_mode::dense ? 0 : 1] == 0.5);
+            child.release(&child);
+            child_schema.release(&child_schema);
+            assert(!child.release && !child_schema.release);
+        }
+
+        // Empty rows have no Arrow representation
+        Columns with_empty;
+        with_empty.push_back(Variant<int32_t, double, int64_t>(1));
+        with_empty.push_back(Variant<int32_t, double, int64_t>());
+        ArrowSchema schema;
+        ArrowArray array;
+        assert(!variant_utils::export_arrow(with_empty, &schema, &array));
+
+        // Duplicate type ids would map two children to the same tag
+        Columns small;
+        small.push_back(Variant<int32_t, double, int64_t>(7));
+        VERIFY(variant_utils::export_arrow(small, &schema, &array));
+        const char *format = schema.format;
+        schema.format = "+ud:0,0,1";
+        Columns back;
+        assert(!variant_utils::import_arrow(&schema, &array, back));
+        variant_utils::ArrowVariantColumns<int32_t, double, int64_t> view;
+        assert(!view.open(&schema, &array));
+        schema.format = format;
+        VERIFY(view.open(&schema, &array) && view.size() == 1);
+        array.release(&array);
+        schema.release(&schema);
+
+        // The buffer count must match the union mode, and the buffers and bounds must be usable
+        VERIFY(variant_utils::export_arrow(small, &schema, &array, variant_utils::arrow_union_mode::sparse));
+        format = schema.format;
+        schema.format = "+ud:0,1,2";
+        assert(!variant_utils::import_arrow(&schema, &array, back));
+        schema.format = format;
+        const void *tags = array.buffers[0];
+        array.buffers[0] = nullptr;
+        assert(!variant_utils::import_arrow(&schema, &array, back));
+        array.buffers[0] = tags;
+        array.offset = -1;
+        assert(!variant_utils::import_arrow(&schema, &array, back));
+        array.offset = 0;
+        VERIFY(back.size() == 0 && variant_utils::import_arrow(&schema, &array, back) && back.size() == 1);
+        array.release(&array);
+        schema.release(&schema);
+    }
+
+    std::cout << "\n--- Testing Hashing and Interning ---\n";
+    {
+        using V = Variant<int64_t, std::string>;
+        std::hash<V> hash;
+        assert(hash(V(int64_t{42})) == hash(V(int64_t{42})));
+        assert(hash(V(std::string("forty-two"))) == hash(V(std::string("forty-two"))));
+        assert(hash(V()) == hash(V()));
+
+        VariantInterner<int64_t, std::string> pool;
+        auto a = pool.intern(V(int64_t{5}));
+        auto b = pool.intern(V(std::string("five")));
+        assert(pool.intern(V(int64_t{5})) == a && a != b);
+        // Equal values share one stored copy, so pointers can be compared directly
+        assert(pool.intern_ptr(V(std::string("five"))) == pool.get_ptr(b));
+        assert(pool.get(b) == V(std::string("five")));
+        assert(*pool.find(V(int64_t{5})) == a && !pool.find(V(int64_t{6})));
+        assert(pool.size() == 2);
+    }
+
+    std::cout << "\n--- Testing NaN-Boxed Values ---\n";
+    {
+        struct Object
+        {
+            int x;
+        };
+        struct Null
+        {
+        };
+        using Value = NanBoxVariant<double, int32_t, bool, Object *, Null>;
+        static_assert(sizeof(Value) == 8);
+
+        Object object{5};
+        Value number(3.5), integer(int32_t{-7}), flag(true), pointer(&object), null(Null{});
+        assert(number.index() == 0 && number.get<double>() == 3.5);
+        assert(integer.index() == 1 && integer.get<int32_t>() == -7);
+        assert(flag.get<bool>() && null.index() == 4);
+        assert(pointer.index() == 3 && pointer.get<Object *>() == &object && pointer.get<Object *>()->x == 5);
+
+        // Every NaN is canonicalized, so none of them can be mistaken for a boxed value
+        Value nan(std::numeric_limits<double>::quiet_NaN()), negative_nan(-std::numeric_limits<double>::quiet_NaN());
+        assert(nan.index() == 0 && nan.get<double>() != nan.get<double>() && !(nan == nan));
+        assert(negative_nan.index() == 0 && negative_nan.raw() == nan.raw());
+        Value minus_infinity(-std::numeric_limits<double>::infinity());
+        assert(minus_infinity.index() == 0 && minus_infinity.get<double>() == -std::numeric_limits<double>::infinity());
+
+        // Upper-half canonical addresses survive the 48-bit payload through sign extension
+        auto *high = reinterpret_cast<Object *>(static_cast<uintptr_t>(0xFFFF800000001000ull));
+        assert(variant_utils::nan_box_traits<Object *>::is_canonical(high));
+        assert(Value(high).get<Object *>() == high);
+        auto *tagged = reinterpret_cast<Object *>(static_cast<uintptr_t>(0x0001000000001000ull));
+        assert(!variant_utils::nan_box_traits<Object *>::is_canonical(tagged));
+
+        // A pointer that would not survive the payload is rejected in every build, and the target keeps its value
+        static_assert(std::is_nothrow_constructible_v<Value, double> && !std::is_nothrow_constructible_v<Value, Object *>);
+        bool rejected = false;
+        try
+        {
+            pointer = tagged;
+        }
+        catch (const std::invalid_argument &)
+        {
+            rejected = true;
+        }
+        assert(rejected && pointer.get<Object *>() == &object);
+    }
+
+    std::cout << "\n--- Testing Never-Empty Policy ---\n";
+    {
+        struct ThrowOnCopy
+        {
+            int value;
+            ThrowOnCopy(int v) : value(v) {}
+            ThrowOnCopy(const ThrowOnCopy &) { throw std::runtime_error("copy"); }
+            ThrowOnCopy(ThrowOnCopy &&other) noexcept : value(other.value) {}
+            ThrowOnCopy &operator=(const ThrowOnCopy &) = default;
+        };
+
+        // The policy is chosen per use; Variant<int, std::string> elsewhere stays nullable
+        using Strict = variant_utils::with_policy_t<variant_utils::never_empty_policy, Variant<int, std::string>>;
+        static_assert(Strict::never_empty && !Variant<int, std::string>::never_empty);
+        Strict fresh;
+        assert(fresh.index() == 0 && fresh.get<int>() == 0);
+
+        // Moving leaves the source holding its moved-from value instead of becoming empty
+        Strict text(std::string("kept"));
+        Strict moved(std::move(text));
+        assert(text.index() == 1 && moved.get<std::string>() == "kept");
+
+        // A throwing copy during assignment leaves the old value in place
+        BasicVariant<variant_utils::never_empty_policy, int, ThrowOnCopy> value(5);
+        const ThrowOnCopy thrower(9);
+        bool threw = false;
+        try
+        {
+            value = thrower;
+        }
+        catch (const std::runtime_error &)
+        {
+            threw = true;
+        }
+        assert(threw && value.index() == 0 && value.get<int>() == 5);
+
+        // A never-empty Variant converts to the nullable one with the same alternatives
+        Variant<int, std::string> nullable(moved);
+        assert(nullable.get<std::string>() == "kept");
+        nullable = std::move(moved);
+        assert(nullable.get<std::string>() == "kept" && moved.index() == 1);
+    }
+
+    std::cout << "\n--- Testing Switch and Table Dispatch Agree ---\n";
+    {
+        // Six alternatives, so neither variant falls back to the if-chain
+        using TableV = Variant<int, double, std::string, char, long, float>;
+        using SwitchV = variant_utils::with_policy_t<variant_utils::switch_policy<variant_utils::default_variant_policy>, TableV>;
+        static_assert(SwitchV::policy::dispatch == variant_utils::dispatch_backend::switch_case);
+
+        std::vector<TableV> table_values;
+        std::vector<SwitchV> switch_values;
+        for (int i = 0; i < 60; ++i)
+        {
+            TableV value;
+            if (i % 6 == 0)
+                value = i;
+            else if (i % 6 == 1)
+                value = i * 0.5;
+            else if (i % 6 == 2)
+                value = std::string(static_cast<size_t>(i), 'x');
+            else if (i % 6 == 3)
+                value = static_cast<char>('a' + i % 26);
+            else if (i % 6 == 4)
+                value = static_cast<long>(i) << 20;
+            else
+                value = i * 0.25f;
+            table_values.push_back(value);
+            switch_values.push_back(SwitchV(value));
+        }
+
+        auto describe = [](const auto &alternative) -> std::string
+        {
+            if constexpr (std::is_same_v<std::decay_t<decltype(alternative)>, std::string>)
+                return "s" + alternative;
+            else
+                return std::to_string(alternative);
+        };
+        for (size_t i = 0; i < table_values.size(); ++i)
+        {
+            assert(table_values[i].index() == switch_values[i].index());
+            assert(table_values[i].visit(describe) == switch_values[i].visit(describe));
+            SwitchV copy = switch_values[i];
+            assert(copy == switch_values[i] && !(copy == switch_values[(i + 1) % switch_values.size()]));
+        }
+    }
+
+    std::cout << "\n--- Testing Likely Dispatch Hints ---\n";
+    {
+        // The hot index is tried first; every other index still reaches the right alternative
+        using Hot = variant_utils::with_policy_t<variant_utils::likely_policy<variant_utils::never_empty_policy, 2>,
+                                                 Variant<int, double, std::string, char, long>>;
+        static_assert(Hot::never_empty);
+        std::vector<Hot> values{Hot(1), Hot(2.5), Hot(std::string("hot")), Hot('c'), Hot(7L)};
+        for (size_t i = 0; i < values.size(); ++i)
+        {
+            Hot copy = values[i];
+            assert(copy.index() == static_cast<int64_t>(i) && copy == values[i]);
+        }
+        assert(values[2].visit([](const auto &value) { return sizeof(value); }) == sizeof(std::string));
+
+#ifdef VARIANT_DISPATCH_PROFILE
+        using Profiled = Variant<short, std::string>;
+        using profile = variant_utils::dispatch_profile<Profiled>;
+        profile::reset();
+        Profiled text(std::string("t")), number(short{1});
+        for (int i = 0; i < 10; ++i)
+            Profiled copy(text);
+        Profiled copy(number);
+        assert(profile::get(1) >= 10 && profile::get(0) >= 1);
+
+        // The hint builds on the current policy of the type list instead of the default one
+        std::ostringstream report;
+        profile::report(report);
+        assert(report.str().find("likely_policy<variant_utils::variant_policy<short, ") != std::string::npos);
+        assert(report.str().find(">, 1>\n") != std::string::npos);
+
+        // The same type list under another policy is counted separately, and its hint keeps that policy
+        using Never = variant_utils::with_policy_t<variant_utils::likely_policy<variant_utils::never_empty_policy, 0>, Profiled>;
+        using never_profile = variant_utils::dispatch_profile<Never>;
+        never_profile::reset();
+        auto text_dispatches = profile::get(1);
+        Never never_text(std::string("n"));
+        for (int i = 0; i < 5; ++i)
+            Never copy(never_text);
+        assert(never_profile::get(1) >= 5 && profile::get(1) == text_dispatches);
+        std::ostringstream never_report;
+        never_profile::report(never_report);
+        assert(never_report.str().find("likely_policy<variant_utils::never_empty_policy, 1>\n") != std::string::npos);
+#endif
+    }
+
+    std::cout << "\n--- Testing Switch and Threaded Executors ---\n";
+    {
+        struct Push
+        {
+            int64_t value;
+        };
+        struct Add
+        {
+        };
+        // Jumps back to target while the top of the stack is below limit
+        struct LoopBelow
+        {
+            int64_t limit;
+            size_t target;
+        };
+        struct Halt
+        {
+        };
+        using Instruction = Variant<Push, Add, LoopBelow, Halt>;
+
+        // Adds 3 until the value reaches 30, then halts with the code size as the stop position
+        const std::vector<Instruction> program{Push{0}, Push{3}, Add{}, LoopBelow{30, 1}, Halt{}};
+        auto run = [&](auto execute)
+        {
+            std::vector<int64_t> stack;
+            size_t steps = 0;
+            size_t stop = execute(program, [&](const auto &ins, size_t pc) -> size_t
+                                  {
+                                      using T = std::decay_t<decltype(ins)>;
+                                      ++steps;
+                                      if constexpr (std::is_same_v<T, Push>)
+                                          stack.push_back(ins.value);
+                                      else if constexpr (std::is_same_v<T, Add>)
+                                      {
+                                          auto rhs = stack.back();
+                                          stack.pop_back();
+                                          stack.back() += rhs;
+                                      }
+                                      else if constexpr (std::is_same_v<T, LoopBelow>)
+                                      {
+                                          if (stack.back() < ins.limit)
+                                              return ins.target;
+                                      }
+                                      else
+                                          return program.size();
+                                      return pc + 1; });
+            assert(stop == program.size());
+            return std::make_pair(stack, steps);
+        };
+
+        auto switched = run([](const auto &code, auto &&f)
+                            { return variant_utils::switch_execute(code, f); });
+        auto threaded = run([](const auto &code, auto &&f)
+                            { return variant_utils::threaded_execute(code, f); });
+        assert(switched.first == std::vector<int64_t>{30} && switched == threaded);
+        assert(switched.second == 1 + 3 * 10 + 1);
+
+        // A callback without pc runs the code in order
+        int64_t pushed = 0;
+        variant_utils::threaded_execute(program.data(), 2, [&](const auto &ins)
+                                        {
+                                            if constexpr (std::is_same_v<std::decay_t<decltype(ins)>, Push>)
+                                                pushed += ins.value + 1; });
+        assert(pushed == 5);
+    }
+
+    std::cout << "\n--- Testing Variant References ---\n";
+    {
+        using Wide = Variant<int, double, std::string>;
+        Wide number(4), text(std::string("view"));
+
+        // Widening a Variant into a view with more alternatives remaps the index at compile time
+        VariantRef<std::string, char, double, int> ref(number);
+        assert(ref.index() == 3 && ref.get<int>() == 4);
+        ref.get<int>() = 5;
+        assert(number.get<int>() == 5);
+        assert(ref.visit([](const auto &value) { return sizeof(value); }) == sizeof(int));
+
+        // Visiting a mutable view writes through to the referenced value
+        VariantRef<int, double, std::string> whole(text);
+        whole.visit([](auto &value)
+                    {
+                        if constexpr (std::is_same_v<std::decay_t<decltype(value)>, std::string>)
+                            value += "!"; });
+        assert(text.get<std::string>() == "view!");
+
+        const Wide &constant = text;
+        VariantView<int, double, std::string> view(constant);
+        assert(view.holds_alternative<std::string>() && &view.get<std::string>() == &text.get<std::string>());
+
+        // Narrowing succeeds only when the current alternative is in the target list
+        auto narrowed = try_narrow_ref<int>(number);
+        assert(narrowed && narrowed->get<int>() == 5);
+        assert(!try_narrow_ref<int>(text));
+        static_assert(std::is_same_v<decltype(try_narrow_ref<int>(constant)), std::optional<VariantView<int>>>);
+
+        Wide empty;
+        VariantView<int, double, std::string> empty_view(empty);
+        assert(empty_view.index() == -1);
+    }
+
+    std::cout << "\n--- Testing Lifecycle Counters ---\n";
+    {
+#ifdef VARIANT_LIFECYCLE_STATS
+        using stats = variant_utils::lifecycle_stats<Tracked>;
+        using event = variant_utils::lifecycle_event;
+        stats::reset();
+#endif
+        {
+            Variant<int, Tracked> a{Tracked()};
+            Variant<int, Tracked> b(a);
+            Variant<int, Tracked> c(std::move(b));
+            c = a;
+            assert(a == c && b.index() == -1);
+        }
+        // Every alternative that was constructed was destroyed, including the moved-from one
+        assert(Tracked::live == 0);
+#ifdef VARIANT_LIFECYCLE_STATS
+        assert(stats::get(event::construct) == 3 && stats::get(event::destroy) == 3);
+        assert(stats::get(event::copy) == 1 && stats::get(event::move) == 2);
+        assert(stats::get(event::assign) == 1 && stats::get(event::compare) == 1);
+#endif
+    }
+
+    std::cout << "\n--- Testing Comparison with Convertible Values ---\n";
+    {
+        Variant<int, std::string> text(std::string("abc")), number(3), empty;
+        const char *pointer = "abc";
+
+        // Compared against the held alternative directly, without building a temporary Variant
+        assert(text == "abc" && text == pointer && text == std::string_view("abc"));
+        assert(!(text == "abd") && !(number == "abc") && !(empty == "abc"));
+        assert(number == 3L && number == 3.0 && !(number == 4));
+        assert(text == std::string("abc"));
+    }
+
+    std::cout << "\n--- Testing Tagged-Pointer Variants ---\n";
+    {
+        struct alignas(4) Leaf
+        {
+            int value;
+        };
+        struct alignas(8) Branch
+        {
+            int64_t children;
+        };
+        using Node = PtrVariant<Leaf *, Branch *, const Leaf *>;
+        static_assert(sizeof(Node) == sizeof(void *) && std::is_trivially_copyable_v<Node>);
+
+        Leaf leaf{7};
+        Branch branch{2};
+        Node node(&leaf);
+        assert(node.index() == 0 && node.get<Leaf *>() == &leaf && node == &leaf);
+        node = &branch;
+        assert(node.holds_alternative<Branch *>() && node.get<1>()->children == 2);
+        node = static_cast<const Leaf *>(&leaf);
+        assert(node.index() == 2 && node.get<const Leaf *>()->value == 7);
+        assert(node.visit([](auto *pointer) { return static_cast<const void *>(pointer); }) == &leaf);
+
+        // Default construction holds a null pointer of the first alternative
+        Node null;
+        assert(null.index() == 0 && null.get<0>() == nullptr);
+
+        // Variant::visit returns the visitor's result for the held alternative
+        Variant<int, std::string> text(std::string("four"));
+        assert(text.visit([](const auto &value) -> size_t
+                          {
+                              if constexpr (std::is_same_v<std::decay_t<decltype(value)>, std::string>)
+                                  return value.size();
+                              else
+                                  return 0; }) == 4);
+    }
+
+    std::cout << "\n--- Testing Widening Between Variants ---\n";
+    {
+        using Narrow = Variant<int, std::string>;
+        using Wide = Variant<std::string, double, int>;
+        static_assert(variant_utils::index_remap<Narrow, std::string, double, int>::table[0] == 2);
+        static_assert(!std::is_constructible_v<Narrow, Wide>);
+
+        Narrow text(std::string("a string long enough to live on the heap")), number(5), empty;
+        Wide copied(text);
+        assert(copied.index() == 0 && copied.get<std::string>() == text.get<std::string>());
+        Wide moved(std::move(text));
+        assert(moved.index() == 0 && text.index() == -1);
+
+        copied = number;
+        assert(copied.index() == 2 && copied.get<int>() == 5);
+        copied = Variant<double>(2.5);
+        assert(copied.index() == 1 && copied.get<double>() == 2.5);
+        copied = empty;
+        assert(copied.index() == -1);
+    }
+
+    std::cout << "\n--- Testing Narrowing to a Smaller Variant ---\n";
+    {
+        using Big = Variant<int, std::string, double, char>;
+        Big text(std::string("a string long enough to live on the heap")), real(2.5), empty;
+
+        auto copied = try_narrow<Variant<std::string, int>>(text);
+        assert(copied && copied->index() == 0 && copied->get<std::string>() == text.get<std::string>());
+        using Small = Variant<int, char>;
+        assert(!try_narrow<Small>(real) && !try_narrow<Small>(empty));
+
+        // Narrowing an rvalue moves the alternative out and leaves the source empty, like a moved-from Variant
+        auto moved = try_narrow<Variant<std::string>>(std::move(text));
+        assert(moved && moved->get<0>() == "a string long enough to live on the heap");
+        assert(text.index() == -1);
+        // A failed move-narrow leaves the source untouched
+        assert(!try_narrow<Small>(std::move(real)) && real.get<double>() == 2.5);
+    }
+
+    std::cout << "\n--- Testing Flattening Nested Variants ---\n";
+    {
+        using variant_utils::type_list;
+        static_assert(std::is_same_v<variant_utils::flatten_t<int, Variant<char, Variant<double>>, int>, type_list<int, char, double, int>>);
+        static_assert(std::is_same_v<variant_utils::unique_t<int, char, int, double, char>, type_list<int, char, double>>);
+        static_assert(variant_utils::has_unique_types_v<int, char> && !variant_utils::has_unique_types_v<int, char, int>);
+
+        using Inner = Variant<std::string, Variant<double, int>>;
+        using Nested = Variant<int, Inner, char>;
+        using Flat = variant_utils::flat_variant_t<int, Inner, char>;
+        static_assert(std::is_same_v<Flat, Variant<int, std::string, double, char>>);
+
+        Nested real(Inner(Variant<double, int>(2.5)));
+        auto flat = variant_utils::flatten_variant(real);
+        assert(flat.index() == 2 && flat.get<double>() == 2.5);
+
+        // The duplicate int inside collapses onto the outer one
+        Nested inner_int(Inner(Variant<double, int>(4)));
+        assert(variant_utils::flatten_variant(inner_int).index() == 0);
+
+        Nested text(Inner(std::string("nested text long enough for the heap")));
+        auto moved = variant_utils::flatten_variant(std::move(text));
+        assert(moved.index() == 1 && moved.get<std::string>() == "nested text long enough for the heap");
+
+        assert(variant_utils::flatten_variant(Nested('c')).get<char>() == 'c');
+        assert(variant_utils::flatten_variant(Nested()).index() == -1);
+    }
+
+    std::cout << "\n--- Testing Serialization Round Trips ---\n";
+    {
+        using Inner = Variant<char, std::string>;
+        using Wire = Variant<int64_t, std::string, double, Inner>;
+        std::vector<Wire> values{Wire(int64_t(-5)), Wire(std::string("hello")), Wire(2.5), Wire(Inner(std::string("inner"))), Wire()};
+
+        alignas(16) char buffer[256];
+        char *out = buffer;
+        size_t total = 0;
+        for (const auto &value : values)
+        {
+            total += variant_utils::serialized_size(value);
+            out = variant_utils::serialize(out, buffer + sizeof(buffer), value);
+            assert(out);
+        }
+        assert(static_cast<size_t>(out - buffer) == total);
+
+        const char *in = buffer;
+        for (const auto &value : values)
+        {
+            Wire read;
+            in = variant_utils::deserialize(in, out, read);
+            assert(in && read == value);
+        }
+        assert(in == out);
+
+        // Truncated input and too-small output are rejected rather than read or written past the end
+        const char *text = buffer + variant_utils::serialized_size(values[0]);
+        for (const char *cut = text; cut < text + variant_utils::serialized_size(values[1]); ++cut)
+        {
+            Wire read;
+            assert(!variant_utils::deserialize(text, cut, read));
+        }
+        char tiny[2];
+        assert(!variant_utils::serialize(tiny, tiny + sizeof(tiny), values[1]));
+        const char bad_index[] = {char(9)};
+        Wire read;
+        assert(!variant_utils::deserialize(bad_index, bad_index + 1, read));
+
+        // Zero-copy reads tell a value that needs a copying read apart from corrupt input
+        using variant_utils::view_status;
+        VariantView<int64_t, std::string, double, Inner> view;
+        alignas(8) char aligned[16] = {};
+        char *aligned_end = variant_utils::serialize(aligned + 7, aligned + sizeof(aligned), values[0]);
+        auto direct = variant_utils::deserialize_view(aligned + 7, aligned_end, view);
+        assert(direct.status == view_status::ok && direct.next == aligned_end && view.get<int64_t>() == -5);
+        assert(&view.get<int64_t>() == reinterpret_cast<const int64_t *>(aligned + 8));
+        assert(variant_utils::deserialize_view(text, out, view).status == view_status::needs_copy);
+        assert(variant_utils::deserialize_view(aligned + 7, aligned_end - 1, view).status == view_status::corrupt);
+        assert(variant_utils::deserialize_view(bad_index, bad_index + 1, view).status == view_status::corrupt);
+    }
+
+    std::cout << "\n--- Testing Copy-on-Write Alternatives ---\n";
+    {
+        using Doc = Variant<int, Cow<std::vector<int>>>;
+        Doc a(Cow<std::vector<int>>(std::vector<int>{1, 2, 3}));
+        Doc b = a;
+        assert(a.get<1>().use_count() == 2);
+        assert(&std::as_const(a).get<1>().read() == &std::as_const(b).get<1>().read());
+
+        // Writing through a shared Cow detaches it; the other copy keeps the old value
+        b.get<1>()->push_back(4);
+        assert(a.get<1>().use_count() == 1 && b.get<1>().use_count() == 1);
+        assert(std::as_const(a).get<1>()->size() == 3 && std::as_const(b).get<1>()->size() == 4);
+        assert(!(a == b));
+
+        // Writing through an unshared Cow does not copy
+        const auto *before = &std::as_const(b).get<1>().read();
+        b.get<1>().write().push_back(5);
+        assert(&std::as_const(b).get<1>().read() == before);
+
+        Doc c = a;
+        assert(c == a);
+        Doc d = std::move(c);
+        assert(d.get<1>().use_count() == 2);
+        a = 1;
+        assert(d.get<1>().use_count() == 1);
+
+        Cow<std::string, false> local(std::string("hi"));
+        auto shared = local;
+        assert(shared.use_count() == 2);
+        shared.write() += "!";
+        assert(local.read() == "hi" && shared.read() == "hi!" && local.use_count() == 1);
+    }
+
+    std::cout << "\n--- Testing Small Tags and Branch Dispatch ---\n";
+    {
+        static_assert(std::is_same_v<variant_utils::index_type_t<2>, int8_t>);
+        static_assert(std::is_same_v<variant_utils::index_type_t<127>, int8_t>);
+        static_assert(std::is_same_v<variant_utils::index_type_t<128>, int16_t>);
+        static_assert(std::is_same_v<variant_utils::index_type_t<32768>, int32_t>);
+        static_assert(sizeof(Variant<char, bool>) == 2);
+        static_assert(sizeof(Variant<int, float>) == 2 * sizeof(int));
+
+        // Two alternatives go through the if-chain for copy, move, compare, visit and destroy
+        Tracked::live = 0;
+        {
+            using Pair = Variant<Tracked, std::string>;
+            Pair a{Tracked{}};
+            a.get<Tracked>().value = 7;
+            Pair b = a;
+            assert(Tracked::live == 2 && b == a);
+            Pair c = std::move(b);
+            assert(Tracked::live == 2 && c.get<Tracked>().value == 7);
+            c = std::string("second alternative");
+            assert(Tracked::live == 1 && c.index() == 1 && !(c == a));
+            auto idx = c.visit([](const auto &value) { return std::is_same_v<trait::remove_cvref_t<decltype(value)>, std::string> ? 1 : 0; });
+            assert(idx == 1);
+            c = a;
+            assert(Tracked::live == 2 && c == a);
+        }
+        assert(Tracked::live == 0);
+    }
+
     std::cout << "\n--- All Tests Passed ---\n";
     // Watch the destructors fire for v1, v2, v4, v6, v7
     return 0;
@@ -0,0 +1,254 @@
+#ifndef INCLUDE_NAN_BOX_VARIANT
+#define INCLUDE_NAN_BOX_VARIANT
+
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+#include "variant.hpp"
+
+namespace variant_utils
+{
+    // NaN-boxing：double 按原样存储（所有 NaN 统一为规范的正 quiet NaN），
+    // 其余备选类型存放在负 quiet NaN 的空间里：
+    //     [63..51] 全为 1 | [50..48] 备选下标 | [47..0] 负载
+    // 因为规范 NaN 的符号位为 0，真正的 double 永远不会落入这个区间。
+    constexpr uint64_t nan_box_prefix = uint64_t{0x1FFF} << 51;
+    constexpr uint64_t nan_box_canonical_nan = uint64_t{0x7FF8} << 48;
+    constexpr uint64_t nan_box_payload_mask = (uint64_t{1} << 48) - 1;
+    constexpr size_t nan_box_max_tags = 8;
+
+    template <typename To, typename From>
+    To bit_cast(const From &from) noexcept
+    {
+        static_assert(sizeof(To) == sizeof(From) && std::is_trivially_copyable_v<From> && std::is_trivially_copyable_v<To>);
+        To to;
+        std::memcpy(&to, &from, sizeof(To));
+        return to;
+    }
+
+    // 描述一个非 double 的类型如何编码进 48 位负载；可为自定义类型特化。
+    // 默认支持 bool、不超过 32 位的整数 / 枚举 / float、指针（要求是 48 位规范地址）以及空类型。
+    template <typename T, typename = void>
+    struct nan_box_traits
+    {
+        constexpr static bool boxable = false;
+    };
+
+    template <typename T>
+    struct nan_box_traits<T, std::enable_if_t<(std::is_integral_v<T> || std::is_enum_v<T> || std::is_same_v<T, float>) && sizeof(T) <= 4>>
+    {
+        constexpr static bool boxable = true;
+
+        using bits_type = std::conditional_t<sizeof(T) == 1, uint8_t, std::conditional_t<sizeof(T) == 2, uint16_t, uint32_t>>;
+
+        static uint64_t encode(T value) noexcept { return bit_cast<bits_type>(value); }
+        static T decode(uint64_t payload) noexcept { return bit_cast<T>(static_cast<bits_type>(payload)); }
+    };
+
+    // 只保存低 48 位，解码时按第 47 位做符号扩展，因此高半区的规范地址也能还原；
+    // 高 16 位不是第 47 位的符号扩展（非规范地址，或带有指针标签 / 认证码的地址）时无法还原，
+    // 编码时总会检查并抛出 std::invalid_argument，不依赖 NDEBUG
+    template <typename T>
+    struct nan_box_traits<T *>
+    {
+        constexpr static bool boxable = true;
+
+        static bool is_canonical(T *value) noexcept
+        {
+            auto bits = static_cast<uint64_t>(reinterpret_cast<uintptr_t>(value));
+            return decode_bits(bits & nan_box_payload_mask) == bits;
+        }
+
+        static uint64_t encode(T *value)
+        {
+            if (!is_canonical(value))
+                throw std::invalid_argument("NanBoxVariant can only store pointers whose upper 16 bits sign-extend bit 47.");
+            return static_cast<uint64_t>(reinterpret_cast<uintptr_t>(value));
+        }
+
+        static T *decode(uint64_t payload) noexcept { return reinterpret_cast<T *>(static_cast<uintptr_t>(decode_bits(payload))); }
+
+    private:
+        static uint64_t decode_bits(uint64_t payload) noexcept
+        {
+            return (payload ^ (uint64_t{1} << 47)) - (uint64_t{1} << 47);
+        }
+    };
+
+    template <typename T>
+    struct nan_box_traits<T, std::enable_if_t<std::is_empty_v<T> && std::is_trivially_default_constructible_v<T>>>
+    {
+        constexpr static bool boxable = true;
+
+        static uint64_t encode(T) noexcept { return 0; }
+        static T decode(uint64_t) noexcept { return T{}; }
+    };
+
+    // 编码 T 是否不会抛出异常；double 不经过 nan_box_traits，视为不抛出
+    template <typename T, typename = void>
+    struct is_nothrow_nan_box_encodable : std::true_type
+    {
+    };
+    template <typename T>
+    struct is_nothrow_nan_box_encodable<T, std::void_t<decltype(nan_box_traits<T>::encode(std::declval<T>()))>>
+        : std::bool_constant<noexcept(nan_box_traits<T>::encode(std::declval<T>()))>
+    {
+    };
+
+    template <typename... Ts>
+    constexpr bool is_nan_boxable_v =
+        sizeof...(Ts) <= nan_box_max_tags &&
+        ((std::is_same_v<Ts, double> ? 1 : 0) + ...) == 1 &&
+        ((std::is_same_v<Ts, double> || nan_box_traits<Ts>::boxable) && ...);
+}
+
+// 以单个 64 位字存储的 Variant，适用于解释器中的值类型，例如
+//     NanBoxVariant<double, int32_t, bool, Object *, Null>
+// 要求备选类型中恰好有一个 double，其余类型都能编码进 48 位（见 nan_box_traits）。
+// 对象可平凡拷贝，拷贝就是一次寄存器移动；不存在空状态，默认构造为第一个备选类型的值初始化。
+// 从指针构造或赋值时，无法装入 48 位的地址抛出 std::invalid_argument，对象保持原值。
+// 与 Variant 不同，get 按值返回。
+template <typename... Ts>
+class NanBoxVariant
+{
+public:
+    static_assert(variant_utils::is_nan_boxable_v<Ts...>,
+                  "NanBoxVariant requires exactly one double alternative, at most 8 alternatives, and all others boxable.");
+
+    constexpr static auto m_size = sizeof...(Ts);
+    constexpr static auto double_idx = variant_utils::find_idx_by_type<double, Ts...>;
+
+private:
+    uint64_t m_bits;
+
+    template <size_t idx, typename T>
+    static uint64_t encode(const T &value) noexcept(variant_utils::is_nothrow_nan_box_encodable<T>::value)
+    {
+        if constexpr (idx == double_idx)
+            return value != value ? variant_utils::nan_box_canonical_nan : variant_utils::bit_cast<uint64_t>(value);
+        else
+            return variant_utils::nan_box_prefix | (uint64_t{idx} << 48) |
+                   (variant_utils::nan_box_traits<T>::encode(value) & variant_utils::nan_box_payload_mask);
+    }
+
+public:
+    NanBoxVariant() noexcept : m_bits(encode<0>(variant_utils::find_type_by_idx_t<0, Ts...>{})) {}
+
+    // 精确匹配优先，否则与 Variant 一样通过重载决议选出不发生窄化的备选类型
+    template <typename T, typename U = trait::remove_cvref_t<T>>
+    constexpr static int64_t assign_idx =
+        variant_utils::find_idx_by_type<U, Ts...> != -1 ? variant_utils::find_idx_by_type<U, Ts...> : variant_utils::find_converting_idx<T, Ts...>;
+
+    template <
+        typename T,
+        typename U = trait::remove_cvref_t<T>,
+        std::enable_if_t<!std::is_same_v<U, NanBoxVariant>, int> = 0,
+        int64_t idx = assign_idx<T>,
+        std::enable_if_t<(idx != -1), int> = 0>
+    NanBoxVariant(T &&val) noexcept(variant_utils::is_nothrow_nan_box_encodable<variant_utils::find_type_by_idx_t<idx, Ts...>>::value)
+        : m_bits(encode<idx>(static_cast<variant_utils::find_type_by_idx_t<idx, Ts...>>(val)))
+    {
+    }
+
+    template <
+        typename T,
+        typename U = trait::remove_cvref_t<T>,
+        std::enable_if_t<!std::is_same_v<U, NanBoxVariant>, int> = 0,
+        int64_t idx = assign_idx<T>,
+        std::enable_if_t<(idx != -1), int> = 0>
+    NanBoxVariant &operator=(T &&val) noexcept(variant_utils::is_nothrow_nan_box_encodable<variant_utils::find_type_by_idx_t<idx, Ts...>>::value)
+    {
+        m_bits = encode<idx>(static_cast<variant_utils::find_type_by_idx_t<idx, Ts...>>(val));
+        return *this;
+    }
+
+public:
+    bool is_boxed() const noexcept { return (m_bits & variant_utils::nan_box_prefix) == variant_utils::nan_box_prefix; }
+
+    int64_t index() const noexcept
+    {
+        return is_boxed() ? static_cast<int64_t>((m_bits >> 48) & (variant_utils::nan_box_max_tags - 1)) : double_idx;
+    }
+
+    template <size_t id>
+    bool holds_alternative() const noexcept { return id == index(); }
+
+    template <typename T>
+    bool holds_alternative() const noexcept
+    {
+        constexpr auto target_idx = variant_utils::find_idx_by_type<trait::remove_cvref_t<T>, Ts...>;
+
+        if constexpr (target_idx == -1)
+            return false;
+        else if constexpr (target_idx == double_idx)
+            return !is_boxed();
+        else
+            return (m_bits >> 48) == ((variant_utils::nan_box_prefix >> 48) | target_idx);
+    }
+
+    template <size_t idx>
+    auto get() const noexcept
+    {
+        using type = variant_utils::find_type_by_idx_t<idx, Ts...>;
+        if constexpr (idx == double_idx)
+            return variant_utils::bit_cast<double>(m_bits);
+        else
+            return variant_utils::nan_box_traits<type>::decode(m_bits & variant_utils::nan_box_payload_mask);
+    }
+
+    template <typename T>
+    auto get() const noexcept
+    {
+        constexpr auto id = variant_utils::find_idx_by_type<T, Ts...>;
+        static_assert(id != -1);
+        return get<id>();
+    }
+
+    // 打包后的原始 64 位字
+    uint64_t raw() const noexcept { return m_bits; }
+
+private:
+    template <size_t I, typename F>
+    static decltype(auto) visit_func_constructor(F &&f, const NanBoxVariant &self)
+    {
+        return std::forward<F>(f)(self.template get<I>());
+    }
+
+    template <typename F, size_t... I>
+    static constexpr auto make_visit_table_impl(std::index_sequence<I...>)
+    {
+        using result_type = decltype(visit_func_constructor<0, F>(std::declval<F>(), std::declval<const NanBoxVariant &>()));
+        using visit_func_type = result_type (*)(F &&, const NanBoxVariant &);
+        return std::array<visit_func_type, sizeof...(Ts)>{&visit_func_constructor<I, F>...};
+    }
+
+    template <typename F>
+    constexpr static auto visit_table = make_visit_table_impl<F>(std::make_index_sequence<sizeof...(Ts)>{});
+
+public:
+    template <typename F>
+    decltype(auto) visit(F &&f) const
+    {
+        return visit_table<F>[index()](std::forward<F>(f), *this);
+    }
+
+public:
+    // 非 double 的值直接比较 64 位字；两个 double 按浮点语义比较（NaN 不等于自身，0.0 == -0.0）
+    bool operator==(const NanBoxVariant &other) const noexcept
+    {
+        if (!is_boxed() && !other.is_boxed())
+            return get<double_idx>() == other.template get<double_idx>();
+        return m_bits == other.m_bits;
+    }
+
+    template <
+        typename T,
+        std::enable_if_t<(variant_utils::find_idx_by_type<T, Ts...> != -1), int> = 0>
+    bool operator==(const T &other) const noexcept
+    {
+        return holds_alternative<T>() && get<T>() == other;
+    }
+};
+
+#endif // INCLUDE_NAN_BOX_VARIANT
@@ -0,0 +1,142 @@
+#ifndef INCLUDE_PTR_VARIANT
+#define INCLUDE_PTR_VARIANT
+
+#include <algorithm>
+
+#include "variant.hpp"
+
+namespace variant_utils
+{
+    // 指针所指对象的对齐，决定了指针低位有多少位恒为 0。
+    // 指向不完整类型时 alignof 不可用，可为该类型特化此模板。
+    template <typename T>
+    struct pointer_alignment : std::integral_constant<size_t, alignof(T)>
+    {
+    };
+
+    template <>
+    struct pointer_alignment<void> : std::integral_constant<size_t, 1>
+    {
+    };
+
+    constexpr size_t floor_log2(size_t n) { return n <= 1 ? 0 : 1 + floor_log2(n / 2); }
+    constexpr size_t ceil_log2(size_t n) { return n <= 1 ? 0 : 1 + floor_log2(n - 1); }
+
+    template <typename... Ts>
+    constexpr size_t free_low_bits = std::min({floor_log2(pointer_alignment<std::remove_cv_t<std::remove_pointer_t<Ts>>>::value)...});
+}
+
+// 只包含指针类型的 Variant：把下标存放在指针因对齐而恒为 0 的低位中，整个对象只占一个指针大小，
+// 并且可以平凡拷贝。默认构造为第一个备选类型的空指针，不存在空状态。
+// 与 Variant 不同，get 按值返回指针本身。
+template <typename... Ts>
+class PtrVariant
+{
+public:
+    static_assert(sizeof...(Ts) > 0, "PtrVariant requires at least one alternative type.");
+    static_assert((std::is_pointer_v<Ts> && ...), "PtrVariant only accepts pointer alternative types.");
+
+    constexpr static auto m_size = sizeof...(Ts);
+    constexpr static size_t tag_bits = variant_utils::ceil_log2(m_size);
+    constexpr static uintptr_t tag_mask = (uintptr_t{1} << tag_bits) - 1;
+
+    static_assert(tag_bits <= variant_utils::free_low_bits<Ts...>,
+                  "Not enough alignment bits in the pointee types to store the alternative index.");
+
+private:
+    uintptr_t m_bits{0};
+
+public:
+    PtrVariant() = default;
+
+    template <
+        typename T,
+        std::enable_if_t<(variant_utils::find_idx_by_type<T, Ts...> != -1), int> = 0>
+    PtrVariant(T ptr) noexcept
+        : m_bits(reinterpret_cast<uintptr_t>(ptr) | static_cast<uintptr_t>(variant_utils::find_idx_by_type<T, Ts...>))
+    {
+    }
+
+    template <
+        typename T,
+        std::enable_if_t<(variant_utils::find_idx_by_type<T, Ts...> != -1), int> = 0>
+    PtrVariant &operator=(T ptr) noexcept
+    {
+        m_bits = reinterpret_cast<uintptr_t>(ptr) | static_cast<uintptr_t>(variant_utils::find_idx_by_type<T, Ts...>);
+        return *this;
+    }
+
+public:
+    template <size_t idx>
+    auto get() const noexcept
+    {
+        using type = variant_utils::find_type_by_idx_t<idx, Ts...>;
+        return reinterpret_cast<type>(m_bits & ~tag_mask);
+    }
+
+    template <typename T>
+    auto get() const noexcept
+    {
+        constexpr auto id = variant_utils::find_idx_by_type<T, Ts...>;
+        static_assert(id != -1);
+        return get<id>();
+    }
+
+    template <size_t id>
+    bool holds_alternative() const noexcept { return id == index(); }
+
+    template <typename T>
+    bool holds_alternative() const noexcept
+    {
+        constexpr auto target_idx = variant_utils::find_idx_by_type<trait::remove_cvref_t<T>, Ts...>;
+
+        if constexpr (target_idx == -1)
+            return false;
+        else
+            return index() == target_idx;
+    }
+
+    int64_t index() const noexcept { return static_cast<int64_t>(m_bits & tag_mask); }
+
+    // 下标与指针一起打包后的原始值，可用作哈希键
+    uintptr_t raw() const noexcept { return m_bits; }
+
+private:
+    template <size_t I, typename F>
+    static decltype(auto) visit_func_constructor(F &&f, uintptr_t bits)
+    {
+        using type = variant_utils::find_type_by_idx_t<I, Ts...>;
+        return std::forward<F>(f)(reinterpret_cast<type>(bits & ~tag_mask));
+    }
+
+    template <typename F, size_t... I>
+    static constexpr auto make_visit_table_impl(std::index_sequence<I...>)
+    {
+        using result_type = decltype(visit_func_constructor<0, F>(std::declval<F>(), uintptr_t{}));
+        using visit_func_type = result_type (*)(F &&, uintptr_t);
+        return std::array<visit_func_type, sizeof...(Ts)>{&visit_func_constructor<I, F>...};
+    }
+
+    template <typename F>
+    constexpr static auto visit_table = make_visit_table_impl<F>(std::make_index_sequence<sizeof...(Ts)>{});
+
+public:
+    template <typename F>
+    decltype(auto) visit(F &&f) const
+    {
+        return visit_table<F>[index()](std::forward<F>(f), m_bits);
+    }
+
+public:
+    bool operator==(const PtrVariant &other) const noexcept { return m_bits == other.m_bits; }
+
+    template <
+        typename T,
+        std::enable_if_t<(variant_utils::find_idx_by_type<T, Ts...> != -1), int> = 0>
+    bool operator==(T ptr) const noexcept
+    {
+        return holds_alternative<T>() && get<T>() == ptr;
+    }
+};
+
+#endif // INCLUDE_PTR_VARIANT
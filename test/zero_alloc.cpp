@@ -0,0 +1,222 @@
+// 热路径零分配测试：统计全局 operator new（glibc 上还包括 malloc 等 C 分配函数）的调用次数，
+// 逐个运行 Variant 的常见操作，任何一次意外的堆分配都使程序以失败状态退出。
+// 替换分配函数会影响整个程序，因此单独成一个测试程序，不与 main.cpp 中的其他测试混在一起。
+//     g++ -std=c++17 -O2 -I.. zero_alloc.cpp -o zero_alloc && ./zero_alloc
+
+#include <array>
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <string>
+#include <utility>
+
+#include "variant.hpp"
+
+// ---------------------------------------------------------------- 分配计数
+
+// operator new 替换普通、nothrow 与对齐三种形式（数组形式默认转发到它们）
+static std::atomic<size_t> g_allocations{0};
+
+void *operator new(std::size_t size)
+{
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void *ptr = std::malloc(size ? size : 1))
+        return ptr;
+    throw std::bad_alloc();
+}
+
+void *operator new(std::size_t size, std::align_val_t align)
+{
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    auto alignment = static_cast<std::size_t>(align);
+    if (void *ptr = std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment))
+        return ptr;
+    throw std::bad_alloc();
+}
+
+// sanitizer 的运行时自带 nothrow 形式，不一并替换的话会与下面的 delete 不配对
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept
+{
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    return std::malloc(size ? size : 1);
+}
+
+void *operator new(std::size_t size, std::align_val_t align, const std::nothrow_t &) noexcept
+{
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    auto alignment = static_cast<std::size_t>(align);
+    return std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+}
+
+void operator delete(void *ptr) noexcept { std::free(ptr); }
+void operator delete(void *ptr, std::size_t) noexcept { std::free(ptr); }
+void operator delete(void *ptr, std::align_val_t) noexcept { std::free(ptr); }
+void operator delete(void *ptr, std::size_t, std::align_val_t) noexcept { std::free(ptr); }
+
+// glibc 上同时截获 C 分配函数；sanitizer 会安装自己的分配器，此时不截获
+#if defined(__GLIBC__) && !defined(__SANITIZE_ADDRESS__) && !defined(__SANITIZE_THREAD__)
+extern "C"
+{
+    void *__libc_malloc(std::size_t);
+    void *__libc_calloc(std::size_t, std::size_t);
+    void *__libc_realloc(void *, std::size_t);
+    void __libc_free(void *);
+
+    void *malloc(std::size_t size)
+    {
+        g_allocations.fetch_add(1, std::memory_order_relaxed);
+        return __libc_malloc(size);
+    }
+
+    void *calloc(std::size_t count, std::size_t size)
+    {
+        g_allocations.fetch_add(1, std::memory_order_relaxed);
+        return __libc_calloc(count, size);
+    }
+
+    void *realloc(void *ptr, std::size_t size)
+    {
+        g_allocations.fetch_add(1, std::memory_order_relaxed);
+        return __libc_realloc(ptr, size);
+    }
+
+    void free(void *ptr) { __libc_free(ptr); }
+}
+#endif
+
+// ---------------------------------------------------------------- 检查
+
+static int g_failures = 0;
+
+// 不用 assert，定义 NDEBUG 时检查同样有效
+#define EXPECT(expr)                                                                  \
+    do                                                                                \
+    {                                                                                 \
+        if (!(expr))                                                                  \
+        {                                                                             \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": check failed: " #expr "\n"; \
+            ++g_failures;                                                             \
+        }                                                                             \
+    } while (0)
+
+// 运行 f，统计其间的堆分配次数，不为 0 时记为失败
+template <typename F>
+void expect_no_allocation(const char *name, F &&f)
+{
+    size_t before = g_allocations.load(std::memory_order_relaxed);
+    f();
+    size_t allocated = g_allocations.load(std::memory_order_relaxed) - before;
+    std::cout << name << ": " << allocated << " allocation(s)\n";
+    if (allocated != 0)
+    {
+        std::cerr << name << ": expected no heap allocation\n";
+        ++g_failures;
+    }
+}
+
+// 定长环形队列，槽位预先构造好，入队与出队都是 Variant 的移动赋值
+template <typename T, size_t N>
+class RingQueue
+{
+private:
+    std::array<T, N> m_slots;
+    size_t m_head{0};
+    size_t m_size{0};
+
+public:
+    bool push(T &&value)
+    {
+        if (m_size == N)
+            return false;
+        m_slots[(m_head + m_size) % N] = std::move(value);
+        ++m_size;
+        return true;
+    }
+
+    bool pop(T &out)
+    {
+        if (m_size == 0)
+            return false;
+        out = std::move(m_slots[m_head]);
+        m_head = (m_head + 1) % N;
+        --m_size;
+        return true;
+    }
+
+    size_t size() const noexcept { return m_size; }
+};
+
+int main()
+{
+    using V = Variant<int, double, std::string>;
+    const std::string long_a(64, 'a'), long_b(64, 'b');
+
+    // 值在检查之外准备好，只统计 Variant 自身的操作
+    V text(long_a), other(long_b), number(1), real(2.5);
+
+    expect_no_allocation("construct int", [&]
+                         { V v(42); EXPECT(v.index() == 0); });
+    expect_no_allocation("construct short string", [&]
+                         { V v("short"); EXPECT(v.index() == 2); });
+    expect_no_allocation("move construct", [&]
+                         { V v(std::move(other)); other = std::move(v); });
+    expect_no_allocation("same-type assign int", [&]
+                         { number = 7; number = V(8); });
+    // 目标的缓冲区足够大，std::string::operator= 直接复用
+    expect_no_allocation("same-type copy assign string", [&]
+                         { text = other; EXPECT(text.get<std::string>() == long_b); });
+    expect_no_allocation("same-type value assign string", [&]
+                         { text = long_a; EXPECT(text.get<std::string>() == long_a); });
+    expect_no_allocation("swap", [&]
+                         { std::swap(text, other); std::swap(number, real); EXPECT(real.get<int>() == 8); });
+    expect_no_allocation("visit", [&]
+                         {
+                             size_t sum = 0;
+                             for (const V *v : {&text, &other, &number, &real})
+                                 sum += v->visit([](const auto &value) -> size_t { return sizeof(value); });
+                             EXPECT(sum > 0); });
+
+    // 消息队列：长字符串随消息在生产者、队列槽位与消费者之间移动，绕环多圈后仍不分配
+    RingQueue<V, 8> queue;
+    std::array<V, 12> messages;
+    for (size_t i = 0; i < messages.size(); ++i)
+    {
+        if (i % 3 == 0)
+            messages[i] = std::string(64, static_cast<char>('a' + i));
+        else if (i % 3 == 1)
+            messages[i] = static_cast<int>(i);
+        else
+            messages[i] = i * 0.5;
+    }
+    const std::string long_d(64, 'd');
+    expect_no_allocation("queue push/pop", [&]
+                         {
+                             V received;
+                             size_t next = 0;
+                             for (int round = 0; round < 4; ++round)
+                                 for (size_t i = 0; i < messages.size(); ++i)
+                                 {
+                                     EXPECT(queue.push(std::move(messages[i])));
+                                     if (queue.size() < 8 && i + 1 < messages.size())
+                                         continue;
+                                     // 先进先出：出队的消息放回它原来的位置
+                                     while (queue.pop(received))
+                                     {
+                                         auto &slot = messages[next++ % messages.size()];
+                                         EXPECT(slot.index() == -1);
+                                         slot = std::move(received);
+                                     }
+                                 }
+                             EXPECT(queue.size() == 0 && next == 4 * messages.size());
+                             EXPECT(messages[3].get<std::string>() == long_d && messages[4].get<int>() == 4 &&
+                                    messages[5].get<double>() == 2.5); });
+
+    if (g_failures != 0)
+    {
+        std::cerr << g_failures << " check(s) failed\n";
+        return EXIT_FAILURE;
+    }
+    std::cout << "all checks passed\n";
+    return 0;
+}
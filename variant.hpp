@@ -1,11 +1,40 @@
 #ifndef INCLUDE_VARIANT
 #define INCLUDE_VARIANT
 
+#include <cstddef>
 #include <cstdint>
 #include <array>
+#include <functional>
 #include <utility>
 #include <type_traits>
 
+#if defined(VARIANT_LIFECYCLE_STATS) || defined(VARIANT_DISPATCH_PROFILE)
+#include <atomic>
+#endif
+
+#ifdef VARIANT_DISPATCH_PROFILE
+#include <algorithm>
+#include <ostream>
+#include <string>
+#include <typeinfo>
+#if defined(__GNUG__) && __has_include(<cxxabi.h>)
+#include <cstdlib>
+#include <cxxabi.h>
+#define VARIANT_DEMANGLE 1
+#endif
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#define VARIANT_LIKELY(x) __builtin_expect(!!(x), 1)
+#define VARIANT_UNREACHABLE() __builtin_unreachable()
+#elif defined(_MSC_VER)
+#define VARIANT_LIKELY(x) (x)
+#define VARIANT_UNREACHABLE() __assume(0)
+#else
+#define VARIANT_LIKELY(x) (x)
+#define VARIANT_UNREACHABLE() ((void)0)
+#endif
+
 namespace trait
 {
     template <typename T>
@@ -30,6 +59,19 @@ namespace trait
     template <typename T>
     inline constexpr bool is_equality_comparable_v = is_equality_comparable<T>::value;
 
+    template <typename T, typename U, typename = void>
+    struct is_equality_comparable_with : std::false_type
+    {
+    };
+
+    template <typename T, typename U>
+    struct is_equality_comparable_with<T, U, std::void_t<decltype(std::declval<T const &>() == std::declval<U const &>())>> : std::true_type
+    {
+    };
+
+    template <typename T, typename U>
+    inline constexpr bool is_equality_comparable_with_v = is_equality_comparable_with<T, U>::value;
+
     template <typename>
     inline constexpr bool always_false_v = false;
 
@@ -37,6 +79,21 @@ namespace trait
     inline constexpr bool always_true_v = true;
 }
 
+namespace variant_utils
+{
+    template <typename... Ts>
+    struct variant_policy;
+}
+
+// 行为由 Policy 决定的 Variant，见 variant_utils::default_variant_policy
+template <typename Policy, typename... Ts>
+class BasicVariant;
+
+// 使用为该类型列表选定的策略 variant_policy<Ts...>（默认为 default_variant_policy）；
+// 单独某处需要不同的策略时直接使用 BasicVariant<Policy, Ts...> 或 variant_utils::with_policy_t
+template <typename... Ts>
+using Variant = BasicVariant<variant_utils::variant_policy<Ts...>, Ts...>;
+
 namespace variant_utils
 {
     template <typename... Ts>
@@ -91,6 +148,315 @@ namespace variant_utils
     template <size_t id, typename... Ts>
     using find_type_by_idx_t = typename find_type_by_idx<id, Ts...>::type;
 
+    // 转换构造：与 std::variant 相同，为每个备选类型 T_i 构造一个重载 F(T_i)，
+    // 只有 T_i x[] = {std::forward<Arg>(arg)} 合法（即不发生窄化转换）时该重载才参与决议，
+    // 由重载决议选出最匹配的备选类型。bool 只接受 bool 本身，避免指针意外转换为 bool。
+    template <typename T>
+    using single_array = T[1];
+
+    template <typename T, typename Arg, typename = void>
+    struct is_non_narrowing_constructible : std::false_type
+    {
+    };
+    template <typename T, typename Arg>
+    struct is_non_narrowing_constructible<T, Arg, std::void_t<decltype(single_array<T>{std::declval<Arg>()})>>
+        : std::bool_constant<!std::is_same_v<std::remove_cv_t<T>, bool> || std::is_same_v<trait::remove_cvref_t<Arg>, bool>>
+    {
+    };
+
+    template <size_t id, typename T>
+    struct converting_candidate
+    {
+        template <typename Arg, std::enable_if_t<is_non_narrowing_constructible<T, Arg>::value, int> = 0>
+        std::integral_constant<int64_t, id> operator()(T, Arg &&) const;
+    };
+
+    template <typename Seq, typename... Ts>
+    struct converting_overloads;
+    template <size_t... I, typename... Ts>
+    struct converting_overloads<std::index_sequence<I...>, Ts...> : converting_candidate<I, Ts>...
+    {
+        using converting_candidate<I, Ts>::operator()...;
+    };
+
+    template <typename Arg, typename Overloads, typename = void>
+    struct converting_position
+    {
+        constexpr static int64_t pos = -1;
+    };
+    template <typename Arg, typename Overloads>
+    struct converting_position<Arg, Overloads, std::void_t<decltype(Overloads{}(std::declval<Arg>(), std::declval<Arg>()))>>
+    {
+        constexpr static int64_t pos = decltype(Overloads{}(std::declval<Arg>(), std::declval<Arg>()))::value;
+    };
+    template <typename Arg, typename... Ts>
+    constexpr auto find_converting_idx = converting_position<Arg, converting_overloads<std::index_sequence_for<Ts...>, Ts...>>::pos;
+
+    // V 是否为 Variant，且其所有备选类型都出现在 Ts... 中（可无损拓宽为 Variant<Ts...>）；不考虑策略，
+    // 因此也包括类型列表相同、策略不同的 Variant
+    template <typename V, typename... Ts>
+    struct is_variant_subset : std::false_type
+    {
+    };
+    template <typename Policy, typename... Us, typename... Ts>
+    struct is_variant_subset<BasicVariant<Policy, Us...>, Ts...>
+        : std::bool_constant<(sizeof...(Us) > 0) && ((find_idx_by_type<Us, Ts...> != -1) && ...)>
+    {
+    };
+    template <typename V, typename... Ts>
+    constexpr bool is_variant_subset_v = is_variant_subset<V, Ts...>::value;
+
+    // 拓宽时的下标重映射表：index_remap<Variant<Us...>, Ts...>::table[i] 为 Us...[i] 在 Ts... 中的下标
+    template <typename V, typename... Ts>
+    struct index_remap;
+    template <typename Policy, typename... Us, typename... Ts>
+    struct index_remap<BasicVariant<Policy, Us...>, Ts...>
+    {
+        constexpr static std::array<int64_t, sizeof...(Us)> table = {find_idx_by_type<Us, Ts...>...};
+    };
+
+    // 类型列表工具
+    template <typename... Ts>
+    struct type_list
+    {
+    };
+
+    // rebind_t<Variant, type_list<A, B>> -> Variant<A, B>
+    template <template <typename...> class To, typename List>
+    struct rebind;
+    template <template <typename...> class To, typename... Ts>
+    struct rebind<To, type_list<Ts...>>
+    {
+        using type = To<Ts...>;
+    };
+    template <template <typename...> class To, typename List>
+    using rebind_t = typename rebind<To, List>::type;
+
+    template <typename... Lists>
+    struct concat;
+    template <>
+    struct concat<>
+    {
+        using type = type_list<>;
+    };
+    template <typename... Ts>
+    struct concat<type_list<Ts...>>
+    {
+        using type = type_list<Ts...>;
+    };
+    template <typename... Ts, typename... Us, typename... Lists>
+    struct concat<type_list<Ts...>, type_list<Us...>, Lists...> : concat<type_list<Ts..., Us...>, Lists...>
+    {
+    };
+    template <typename... Lists>
+    using concat_t = typename concat<Lists...>::type;
+
+    // 展开嵌套的 Variant：flatten_t<A, Variant<B, Variant<C>>> -> type_list<A, B, C>
+    template <typename... Ts>
+    struct flatten;
+    template <typename T>
+    struct flatten<T>
+    {
+        using type = type_list<T>;
+    };
+    template <typename Policy, typename... Us>
+    struct flatten<BasicVariant<Policy, Us...>> : flatten<Us...>
+    {
+    };
+    template <typename... Ts>
+    struct flatten
+    {
+        using type = concat_t<typename flatten<Ts>::type...>;
+    };
+    template <typename... Ts>
+    using flatten_t = typename flatten<Ts...>::type;
+
+    // 去除重复类型并保留首次出现的顺序：unique_t<A, B, A> -> type_list<A, B>
+    template <typename Result, typename... Ts>
+    struct unique_impl;
+    template <typename... Rs>
+    struct unique_impl<type_list<Rs...>>
+    {
+        using type = type_list<Rs...>;
+    };
+    template <typename... Rs, typename T, typename... Ts>
+    struct unique_impl<type_list<Rs...>, T, Ts...>
+        : unique_impl<std::conditional_t<(std::is_same_v<T, Rs> || ...), type_list<Rs...>, type_list<Rs..., T>>, Ts...>
+    {
+    };
+    template <typename... Ts>
+    struct unique : unique_impl<type_list<>, Ts...>
+    {
+    };
+    template <typename... Ts>
+    using unique_t = typename unique<Ts...>::type;
+
+    // find_idx_by_type 遇到重复类型时只会返回第一个，可用它在编译期检查
+    template <typename... Ts>
+    constexpr bool has_unique_types_v = std::is_same_v<unique_t<Ts...>, type_list<Ts...>>;
+
+    // Variant<A, Variant<B, C>, A> -> Variant<A, B, C>
+    template <typename... Ts>
+    using flat_variant_t = rebind_t<Variant, typename rebind_t<unique, flatten_t<Ts...>>::type>;
+
+    // 分发方式：table 按下标查函数指针表；switch_case 展开为 switch，
+    // 每个 case 直接调用具体函数，可以内联，下标已知时（例如刚判断过 holds_alternative）还能做常量传播。
+    // switch_case 最多支持 switch_dispatch_limit 个备选类型，超出时仍使用函数指针表。
+    enum class dispatch_backend
+    {
+        table,
+        switch_case
+    };
+
+    constexpr size_t switch_dispatch_limit = 64;
+
+    // Variant 的行为策略。默认策略与原有行为一致；
+    // 为某个类型列表特化 variant_policy<Ts...> 即可改变所有 Variant<Ts...> 的行为，例如：
+    //     template <>
+    //     struct variant_utils::variant_policy<int, std::string> : variant_utils::never_empty_policy {};
+    // 只想改变某一处时直接写 BasicVariant<never_empty_policy, int, std::string>，或用 with_policy_t 换掉已有类型的策略。
+    struct default_variant_policy
+    {
+        constexpr static bool never_empty = false;
+
+        // 热点备选下标：分发时先按顺序内联比较这些下标，未命中才走函数指针表
+        using likely_indices = std::index_sequence<>;
+
+        // 备选类型不超过这个数目时，分发展开为一串 if，每个分支都是对具体函数的直接调用，可以被完全内联；
+        // 设为 0 则总是查函数指针表
+        constexpr static size_t branch_dispatch_limit = 4;
+
+        // 超过 branch_dispatch_limit 时的分发方式
+        constexpr static dispatch_backend dispatch = dispatch_backend::table;
+    };
+
+    // 永不为空：默认构造第一个备选类型，移动后源对象保留被移动后的值，
+    // 析构、拷贝、比较中不再判断 null_type。要求所有备选类型都能 noexcept 移动构造。
+    struct never_empty_policy : default_variant_policy
+    {
+        constexpr static bool never_empty = true;
+    };
+
+    template <typename... Ts>
+    struct variant_policy : default_variant_policy
+    {
+    };
+
+    // 在任意策略上指定热点下标，例如 likely_policy<never_empty_policy, 0>；Base 中已有的热点下标被 Hot... 替换
+    template <typename Base, size_t... Hot>
+    struct likely_policy : Base
+    {
+        using likely_indices = std::index_sequence<Hot...>;
+    };
+
+    // 去掉最外层的 likely_policy，得到其余设置所在的策略
+    template <typename Policy>
+    struct without_likely
+    {
+        using type = Policy;
+    };
+    template <typename Base, size_t... Hot>
+    struct without_likely<likely_policy<Base, Hot...>>
+    {
+        using type = Base;
+    };
+
+    // 在任意策略上改用 switch 分发，例如 switch_policy<never_empty_policy>
+    template <typename Base>
+    struct switch_policy : Base
+    {
+        constexpr static dispatch_backend dispatch = dispatch_backend::switch_case;
+    };
+
+    // 类型列表不变、换用另一种策略：with_policy_t<switch_policy<default_variant_policy>, Variant<A, B>>
+    template <typename Policy, typename V>
+    struct with_policy;
+    template <typename Policy, typename Old, typename... Ts>
+    struct with_policy<Policy, BasicVariant<Old, Ts...>>
+    {
+        using type = BasicVariant<Policy, Ts...>;
+    };
+    template <typename Policy, typename V>
+    using with_policy_t = typename with_policy<Policy, V>::type;
+
+    // 能容纳全部下标与 null_type 的最小有符号整数，作为 Variant 的标签类型
+    template <size_t N>
+    using index_type_t = std::conditional_t<(N < 128), int8_t, std::conditional_t<(N < 32768), int16_t, int32_t>>;
+
+#ifdef VARIANT_DISPATCH_PROFILE
+    // 可读的类型名：GCC / Clang 上还原 typeid 的修饰名，其他编译器原样返回
+    template <typename T>
+    std::string type_name()
+    {
+#ifdef VARIANT_DEMANGLE
+        int status = 0;
+        if (char *name = abi::__cxa_demangle(typeid(T).name(), nullptr, nullptr, &status))
+        {
+            std::string result = status == 0 ? name : typeid(T).name();
+            std::free(name);
+            return result;
+        }
+#endif
+        return typeid(T).name();
+    }
+
+    // 分发频率统计：定义 VARIANT_DISPATCH_PROFILE 后，每次按下标分发都会计数，
+    // report 输出各备选类型的占比以及可直接粘贴的 likely_policy 建议。
+    // 按完整的 BasicVariant<Policy, Ts...> 分别计数，类型列表相同、策略不同的 Variant 互不影响；
+    // 建议以该类型当前的策略为基础，保留其中已有的设置（never_empty、分发方式等），只替换热点下标。
+    template <typename V>
+    struct dispatch_profile;
+    template <typename Policy, typename... Ts>
+    struct dispatch_profile<BasicVariant<Policy, Ts...>>
+    {
+        static inline std::atomic<uint64_t> counters[sizeof...(Ts)]{};
+
+        static void record(size_t idx) noexcept { counters[idx].fetch_add(1, std::memory_order_relaxed); }
+
+        static uint64_t get(size_t idx) noexcept { return counters[idx].load(std::memory_order_relaxed); }
+
+        static void reset() noexcept
+        {
+            for (auto &counter : counters)
+                counter.store(0, std::memory_order_relaxed);
+        }
+
+        // 按频率从高到低选取下标，直到累计占比达到 coverage
+        static void report(std::ostream &os, double coverage = 0.9)
+        {
+            const std::string names[] = {type_name<Ts>()...};
+
+            std::array<uint64_t, sizeof...(Ts)> counts{};
+            std::array<size_t, sizeof...(Ts)> order{};
+            uint64_t total = 0;
+            for (size_t i = 0; i < sizeof...(Ts); ++i)
+            {
+                counts[i] = get(i);
+                order[i] = i;
+                total += counts[i];
+            }
+            std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b)
+                             { return counts[a] > counts[b]; });
+
+            os << "Variant dispatch profile (" << total << " dispatches):\n";
+            for (auto i : order)
+                os << "  [" << i << "] " << names[i] << ": " << counts[i] << " ("
+                   << (total ? 100.0 * counts[i] / total : 0.0) << "%)\n";
+
+            os << "suggested hint: variant_utils::likely_policy<" << type_name<typename without_likely<Policy>::type>();
+            uint64_t covered = 0;
+            for (auto i : order)
+            {
+                if (total == 0 || counts[i] == 0 || covered >= coverage * total)
+                    break;
+                covered += counts[i];
+                os << ", " << i;
+            }
+            os << ">\n";
+        }
+    };
+#endif
+
     template <typename... Ts>
     struct Storage;
     template <>
@@ -141,14 +507,6 @@ namespace variant_utils
 
     template <typename Head, typename... Ts>
     void construct_variant_value(Storage<Ts...> &, Head &&);
-    template <typename Head, typename... Ts, std::enable_if_t<(find_idx_by_type<Head, Ts...> == -1), int> = 0>
-    void construct_variant_value(Storage<Head> &, Head &&) { static_assert(trait::always_false_v<Ts...>, "Can't find type T in Ts...!"); }
-    template <typename T>
-    void construct_variant_value(Storage<T> &storage, T &&val)
-    {
-        using U = trait::remove_cvref_t<T>;
-        *new (&storage.value) U(std::forward<T>(val));
-    }
     template <typename T, typename Head, typename... Ts>
     void construct_variant_value(Storage<Head, Ts...> &storage, T &&val)
     {
@@ -159,6 +517,72 @@ namespace variant_utils
             construct_variant_value<T, Ts...>(storage.next, std::forward<T>(val));
     }
 
+    // 生命周期统计：定义 VARIANT_LIFECYCLE_STATS 后，按备选类型统计构造、拷贝、移动、
+    // 同类型赋值、析构与比较次数；未定义时 record_lifecycle 为空函数，不产生任何代码。
+    // construct 统计所有新建的备选对象，copy / move 是其中由拷贝 / 移动构造得到的部分。
+    enum class lifecycle_event : size_t
+    {
+        construct,
+        copy,
+        move,
+        assign,
+        destroy,
+        compare,
+        count
+    };
+
+#ifdef VARIANT_LIFECYCLE_STATS
+    inline constexpr bool lifecycle_stats_enabled = true;
+
+    template <typename T>
+    struct lifecycle_stats
+    {
+        using snapshot_type = std::array<uint64_t, static_cast<size_t>(lifecycle_event::count)>;
+
+        static inline std::atomic<uint64_t> counters[static_cast<size_t>(lifecycle_event::count)]{};
+
+        static void record(lifecycle_event event) noexcept
+        {
+            counters[static_cast<size_t>(event)].fetch_add(1, std::memory_order_relaxed);
+        }
+
+        static uint64_t get(lifecycle_event event) noexcept
+        {
+            return counters[static_cast<size_t>(event)].load(std::memory_order_relaxed);
+        }
+
+        static snapshot_type snapshot() noexcept
+        {
+            snapshot_type result{};
+            for (size_t i = 0; i < result.size(); ++i)
+                result[i] = counters[i].load(std::memory_order_relaxed);
+            return result;
+        }
+
+        static void reset() noexcept
+        {
+            for (auto &counter : counters)
+                counter.store(0, std::memory_order_relaxed);
+        }
+    };
+
+    template <typename T>
+    inline void record_lifecycle(lifecycle_event event) noexcept { lifecycle_stats<trait::remove_cvref_t<T>>::record(event); }
+#else
+    inline constexpr bool lifecycle_stats_enabled = false;
+
+    template <typename T>
+    inline void record_lifecycle(lifecycle_event) noexcept {}
+#endif
+
+    template <typename T, typename Arg>
+    inline void record_value_construction() noexcept
+    {
+        record_lifecycle<T>(lifecycle_event::construct);
+        if constexpr (std::is_same_v<trait::remove_cvref_t<Arg>, trait::remove_cvref_t<T>>)
+            record_lifecycle<T>(std::is_lvalue_reference_v<Arg> ? lifecycle_event::copy : lifecycle_event::move);
+    }
+
     template <size_t id, typename... Ts>
     void destroy_variant_value(Storage<Ts...> &);
     template <size_t id, typename... Ts, std::enable_if_t<(id >= sizeof...(Ts)), int> = 0>
@@ -174,19 +598,27 @@ namespace variant_utils
     }
 }
 
-template <typename... Ts>
-class Variant
+template <typename Policy, typename... Ts>
+class BasicVariant
 {
 public:
     constexpr static auto is_all_trivially_destructible = variant_utils::is_all_trivially_destructible_v<Ts...>;
     constexpr static auto m_size = sizeof...(Ts);
     constexpr static auto null_type = -1;
 
-    // template <typename...>
-    // friend class Variant;
+    using policy = Policy;
+    constexpr static bool never_empty = policy::never_empty;
+
+    static_assert(!never_empty || (std::is_nothrow_move_constructible_v<Ts> && ...),
+                  "never-empty Variant requires all alternative types to be nothrow move constructible.");
+
+    template <typename, typename...>
+    friend class BasicVariant;
 
 private:
-    int64_t type_idx{null_type};
+    using index_type = variant_utils::index_type_t<sizeof...(Ts)>;
+
+    index_type type_idx{null_type};
     variant_utils::Storage<Ts...> m_storage;
 
 public:
@@ -227,7 +659,141 @@ public:
         return (this->type_idx) == target_idx;
     }
 
-    auto index() const { return type_idx; }
+    int64_t index() const { return type_idx; }
+
+private:
+    using likely_indices = typename policy::likely_indices;
+
+    template <size_t... Hot>
+    static constexpr bool check_likely_indices(std::index_sequence<Hot...>) { return ((Hot < sizeof...(Ts)) && ...); }
+    static_assert(check_likely_indices(likely_indices{}), "likely_indices contains an index that is out of range!");
+
+    // 按运行时下标调用函数指针表中的第 idx 项。
+    // table 是编译期常量，table[Hot] 会被直接解析为具体函数，从而可以被内联。
+    template <const auto &table, size_t I, typename... Args>
+    static decltype(auto) dispatch_branch(size_t idx, Args &&...args)
+    {
+        if constexpr (I + 1 == sizeof...(Ts))
+            return table[I](std::forward<Args>(args)...);
+        else
+        {
+            if (idx == I)
+                return table[I](std::forward<Args>(args)...);
+            return dispatch_branch<table, I + 1>(idx, std::forward<Args>(args)...);
+        }
+    }
+
+#define VARIANT_DISPATCH_CASE(I)                                  \
+    case (I):                                                     \
+        if constexpr ((I) < sizeof...(Ts))                        \
+            return table[(I)](std::forward<Args>(args)...);       \
+        else                                                      \
+            VARIANT_UNREACHABLE();
+#define VARIANT_DISPATCH_CASES_4(I) \
+    VARIANT_DISPATCH_CASE(I)        \
+    VARIANT_DISPATCH_CASE(I + 1)    \
+    VARIANT_DISPATCH_CASE(I + 2)    \
+    VARIANT_DISPATCH_CASE(I + 3)
+#define VARIANT_DISPATCH_CASES_16(I) \
+    VARIANT_DISPATCH_CASES_4(I)      \
+    VARIANT_DISPATCH_CASES_4(I + 4)  \
+    VARIANT_DISPATCH_CASES_4(I + 8)  \
+    VARIANT_DISPATCH_CASES_4(I + 12)
+
+    // 展开出 switch_dispatch_limit 个 case，超出 Ts... 的 case 在编译期被丢弃
+    template <const auto &table, typename... Args>
+    static decltype(auto) dispatch_switch(size_t idx, Args &&...args)
+    {
+        static_assert(sizeof...(Ts) <= variant_utils::switch_dispatch_limit);
+        switch (idx)
+        {
+            VARIANT_DISPATCH_CASES_16(0)
+            VARIANT_DISPATCH_CASES_16(16)
+            VARIANT_DISPATCH_CASES_16(32)
+            VARIANT_DISPATCH_CASES_16(48)
+        default:
+            VARIANT_UNREACHABLE();
+        }
+        return table[idx](std::forward<Args>(args)...);
+    }
+
+#undef VARIANT_DISPATCH_CASES_16
+#undef VARIANT_DISPATCH_CASES_4
+#undef VARIANT_DISPATCH_CASE
+
+    template <const auto &table, typename... Args>
+    static decltype(auto) dispatch_fallback(size_t idx, Args &&...args)
+    {
+        if constexpr (sizeof...(Ts) <= policy::branch_dispatch_limit)
+            return dispatch_branch<table, 0>(idx, std::forward<Args>(args)...);
+        else if constexpr (policy::dispatch == variant_utils::dispatch_backend::switch_case &&
+                           sizeof...(Ts) <= variant_utils::switch_dispatch_limit)
+            return dispatch_switch<table>(idx, std::forward<Args>(args)...);
+        else
+            return table[idx](std::forward<Args>(args)...);
+    }
+
+    template <const auto &table, size_t Hot, size_t... Rest, typename... Args>
+    static decltype(auto) dispatch_likely(size_t idx, Args &&...args)
+    {
+        if (VARIANT_LIKELY(idx == Hot))
+            return table[Hot](std::forward<Args>(args)...);
+        if constexpr (sizeof...(Rest) == 0)
+            return dispatch_fallback<table>(idx, std::forward<Args>(args)...);
+        else
+            return dispatch_likely<table, Rest...>(idx, std::forward<Args>(args)...);
+    }
+
+    template <const auto &table, size_t... Hot, typename... Args>
+    static decltype(auto) dispatch_impl(std::index_sequence<Hot...>, size_t idx, Args &&...args)
+    {
+        if constexpr (sizeof...(Hot) == 0)
+            return dispatch_fallback<table>(idx, std::forward<Args>(args)...);
+        else
+            return dispatch_likely<table, Hot...>(idx, std::forward<Args>(args)...);
+    }
+
+    template <const auto &table, typename... Args>
+    static decltype(auto) dispatch(size_t idx, Args &&...args)
+    {
+#ifdef VARIANT_DISPATCH_PROFILE
+        variant_utils::dispatch_profile<BasicVariant>::record(idx);
+#endif
+        return dispatch_impl<table>(likely_indices{}, idx, std::forward<Args>(args)...);
+    }
+
+private:
+    template <size_t I, typename F, typename StoragePtr>
+    static decltype(auto) visit_func_constructor(F &&f, StoragePtr storage)
+    {
+        return std::forward<F>(f)(variant_utils::get_storage_value<I>(*storage));
+    }
+
+    template <typename F, typename StoragePtr, size_t... I>
+    static constexpr auto make_visit_table_impl(std::index_sequence<I...>)
+    {
+        using result_type = decltype(visit_func_constructor<0, F, StoragePtr>(std::declval<F>(), std::declval<StoragePtr>()));
+        using visit_func_type = result_type (*)(F &&, StoragePtr);
+        return std::array<visit_func_type, sizeof...(Ts)>{&visit_func_constructor<I, F, StoragePtr>...};
+    }
+
+    template <typename F, typename StoragePtr>
+    constexpr static auto visit_table = make_visit_table_impl<F, StoragePtr>(std::make_index_sequence<sizeof...(Ts)>{});
+
+public:
+    // 以当前持有的值调用 f，所有备选类型的返回类型需与第一个备选类型一致。
+    // 调用前 Variant 不能为空。
+    template <typename F>
+    decltype(auto) visit(F &&f)
+    {
+        return dispatch<visit_table<F, variant_utils::Storage<Ts...> *>>(type_idx, std::forward<F>(f), &m_storage);
+    }
+
+    template <typename F>
+    decltype(auto) visit(F &&f) const
+    {
+        return dispatch<visit_table<F, const variant_utils::Storage<Ts...> *>>(type_idx, std::forward<F>(f), &m_storage);
+    }
 
 private:
     using destroy_func_type = void (*)(void *);
@@ -235,34 +801,51 @@ private:
     static void destroy_value_func_constructor(void *ptr)
     {
         auto &storage = *static_cast<variant_utils::Storage<Ts...> *>(ptr);
+        variant_utils::record_lifecycle<T>(variant_utils::lifecycle_event::destroy);
         variant_utils::destroy_variant_value<variant_utils::find_idx_by_type<T, Ts...>>(storage);
     }
     constexpr static destroy_func_type destroy_func[] = {destroy_value_func_constructor<Ts>...};
     void destroy()
     {
-        if (type_idx != null_type)
-            destroy_func[type_idx](&m_storage);
+        if constexpr (never_empty)
+            dispatch<destroy_func>(type_idx, &m_storage);
+        else if (type_idx != null_type)
+            dispatch<destroy_func>(type_idx, &m_storage);
+    }
+
+    // 可为空的 Variant 被移走后置为空：被移走的值仍需析构，否则其资源与生命周期计数都对不上
+    void clear_moved_from() noexcept
+    {
+        if constexpr (!never_empty)
+        {
+            destroy();
+            type_idx = null_type;
+        }
     }
 
 private:
     template <size_t id>
-    static void construct_from_impl(Variant *self, const Variant &other)
+    static void construct_from_impl(BasicVariant *self, const BasicVariant &other)
     {
         using type = variant_utils::find_type_by_idx_t<id, Ts...>;
         auto &place = other.template get<id>();
         new (&self->template get<id>()) type(place);
+        variant_utils::record_lifecycle<type>(variant_utils::lifecycle_event::construct);
+        variant_utils::record_lifecycle<type>(variant_utils::lifecycle_event::copy);
     }
 
     template <size_t id>
-    static void construct_from_impl_move(Variant *self, Variant &&other)
+    static void construct_from_impl_move(BasicVariant *self, BasicVariant &&other)
     {
         using type = variant_utils::find_type_by_idx_t<id, Ts...>;
         auto &place = self->template get<id>();
         new (&place) type(std::move(other.template get<id>()));
+        variant_utils::record_lifecycle<type>(variant_utils::lifecycle_event::construct);
+        variant_utils::record_lifecycle<type>(variant_utils::lifecycle_event::move);
     }
 
-    using constructor_func_type = void (*)(Variant *, const Variant &);
-    using move_constructor_func_type = void (*)(Variant *, Variant &&);
+    using constructor_func_type = void (*)(BasicVariant *, const BasicVariant &);
+    using move_constructor_func_type = void (*)(BasicVariant *, BasicVariant &&);
 
     template <size_t... I>
     static constexpr std::array<constructor_func_type, sizeof...(Ts)>
@@ -274,44 +857,195 @@ private:
     make_move_constructor_table_impl(std::index_sequence<I...>) { return {&construct_from_impl_move<I>...}; }
     static constexpr auto make_move_constructor_table() { return make_move_constructor_table_impl(std::make_index_sequence<sizeof...(Ts)>{}); }
 
-    void construct_from(const Variant &other)
+    constexpr static auto constructor_table = make_constructor_table();
+    constexpr static auto move_constructor_table = make_move_constructor_table();
+
+    // 同类型赋值：直接调用备选类型自己的赋值运算符，可以复用已有的资源（例如字符串的缓冲区），不必析构后重新构造
+    constexpr static bool is_all_copy_assignable = (std::is_copy_assignable_v<Ts> && ...);
+    constexpr static bool is_all_move_assignable = (std::is_move_assignable_v<Ts> && ...);
+
+    // 只在所有备选类型都可赋值时被调用；其余情况下表项不会被用到，也就不要求该类型可赋值
+    template <size_t id>
+    static void assign_from_impl(BasicVariant *self, const BasicVariant &other)
+    {
+        if constexpr (is_all_copy_assignable)
+            self->template get<id>() = other.template get<id>();
+    }
+
+    template <size_t id>
+    static void assign_from_impl_move(BasicVariant *self, BasicVariant &&other)
+    {
+        if constexpr (is_all_move_assignable)
+            self->template get<id>() = std::move(other.template get<id>());
+    }
+
+    template <size_t... I>
+    static constexpr std::array<constructor_func_type, sizeof...(Ts)>
+    make_assign_table_impl(std::index_sequence<I...>) { return {&assign_from_impl<I>...}; }
+
+    template <size_t... I>
+    static constexpr std::array<move_constructor_func_type, sizeof...(Ts)>
+    make_move_assign_table_impl(std::index_sequence<I...>) { return {&assign_from_impl_move<I>...}; }
+
+    constexpr static auto assign_table = make_assign_table_impl(std::make_index_sequence<sizeof...(Ts)>{});
+    constexpr static auto move_assign_table = make_move_assign_table_impl(std::make_index_sequence<sizeof...(Ts)>{});
+
+    // 两边持有同一备选类型（且不为空）
+    bool holds_same_alternative(const BasicVariant &other) const noexcept
+    {
+        return type_idx == other.type_idx && (never_empty || type_idx != null_type);
+    }
+
+    using record_func_type = void (*)(variant_utils::lifecycle_event) noexcept;
+    constexpr static record_func_type record_func[] = {&variant_utils::record_lifecycle<Ts>...};
+
+    // 赋值前后持有同一备选类型时记为一次同类型赋值
+    void record_same_type_assign(int64_t incoming_idx) const noexcept
+    {
+        if constexpr (variant_utils::lifecycle_stats_enabled)
+            if ((never_empty || type_idx != null_type) && type_idx == incoming_idx)
+                record_func[type_idx](variant_utils::lifecycle_event::assign);
+    }
+
+    void construct_from(const BasicVariant &other)
     {
-        type_idx = null_type;
+        if constexpr (!never_empty)
+        {
+            type_idx = null_type;
 
-        if (other.type_idx == null_type)
-            return;
+            if (other.type_idx == null_type)
+                return;
+        }
 
-        static constexpr auto table = make_constructor_table();
-        table[other.type_idx](this, other);
+        dispatch<constructor_table>(other.type_idx, this, other);
 
         type_idx = other.type_idx;
     }
 
-    void construct_from(Variant &&other)
+    void construct_from(BasicVariant &&other)
     {
-        type_idx = null_type;
+        if constexpr (!never_empty)
+        {
+            type_idx = null_type;
 
-        if (other.type_idx == null_type)
-            return;
+            if (other.type_idx == null_type)
+                return;
+        }
 
-        static constexpr auto table = make_move_constructor_table();
-        table[other.type_idx](this, std::move(other));
+        dispatch<move_constructor_table>(other.type_idx, this, std::move(other));
 
         type_idx = other.type_idx;
     }
 
+    // 从类型列表是子集的 Variant 拓宽：按源下标查一次表，表项在编译期就知道目标下标，
+    // 直接在目标位置拷贝 / 移动构造对应的值。
+    template <size_t I, typename Other>
+    static void construct_from_subset_impl(BasicVariant *self, Other other)
+    {
+        using source_type = std::remove_reference_t<Other>;
+        using type = trait::remove_cvref_t<decltype(other.template get<I>())>;
+        constexpr auto target = variant_utils::index_remap<std::remove_const_t<source_type>, Ts...>::table[I];
+
+        if constexpr (std::is_lvalue_reference_v<Other>)
+        {
+            new (&self->template get<target>()) type(other.template get<I>());
+            variant_utils::record_lifecycle<type>(variant_utils::lifecycle_event::copy);
+        }
+        else
+        {
+            new (&self->template get<target>()) type(std::move(other.template get<I>()));
+            variant_utils::record_lifecycle<type>(variant_utils::lifecycle_event::move);
+        }
+        variant_utils::record_lifecycle<type>(variant_utils::lifecycle_event::construct);
+        self->type_idx = target;
+    }
+
+    template <typename Other, size_t... I>
+    static constexpr auto make_subset_table_impl(std::index_sequence<I...>)
+    {
+        using subset_func_type = void (*)(BasicVariant *, Other);
+        return std::array<subset_func_type, sizeof...(I)>{&construct_from_subset_impl<I, Other>...};
+    }
+
+    template <typename Other>
+    constexpr static auto subset_table = make_subset_table_impl<Other>(
+        std::make_index_sequence<std::remove_reference_t<Other>::m_size>{});
+
+    template <typename UPolicy, typename... Us>
+    void construct_from_subset(const BasicVariant<UPolicy, Us...> &other)
+    {
+        static_assert(!never_empty || BasicVariant<UPolicy, Us...>::never_empty,
+                      "A never-empty Variant can only be widened from a never-empty Variant.");
+        if constexpr (!never_empty)
+        {
+            type_idx = null_type;
+
+            if (other.type_idx == null_type)
+                return;
+        }
+
+        subset_table<const BasicVariant<UPolicy, Us...> &>[other.type_idx](this, other);
+    }
+
+    template <typename UPolicy, typename... Us>
+    void construct_from_subset(BasicVariant<UPolicy, Us...> &&other)
+    {
+        static_assert(!never_empty || BasicVariant<UPolicy, Us...>::never_empty,
+                      "A never-empty Variant can only be widened from a never-empty Variant.");
+        if constexpr (!never_empty)
+        {
+            type_idx = null_type;
+
+            if (other.type_idx == null_type)
+                return;
+        }
+
+        subset_table<BasicVariant<UPolicy, Us...> &&>[other.type_idx](this, std::move(other));
+
+        other.clear_moved_from();
+    }
+
 public:
-    Variant() {};
+    BasicVariant()
+    {
+        if constexpr (never_empty)
+        {
+            using type = variant_utils::find_type_by_idx_t<0, Ts...>;
+            static_assert(std::is_default_constructible_v<type>,
+                          "never-empty Variant requires its first alternative type to be default constructible.");
+            new (&get<0>()) type();
+            variant_utils::record_lifecycle<type>(variant_utils::lifecycle_event::construct);
+            type_idx = 0;
+        }
+    }
 
     template <
         typename T,
         typename U = trait::remove_cvref_t<T>,
-        std::enable_if_t<!std::is_same_v<U, Variant>, int> = 0,
+        std::enable_if_t<!std::is_same_v<U, BasicVariant>, int> = 0,
         std::enable_if_t<(variant_utils::find_idx_by_type<U, Ts...> != -1), int> = 0>
-    Variant(T &&val)
+    BasicVariant(T &&val)
     {
         constexpr auto idx = variant_utils::find_idx_by_type<U, Ts...>;
         variant_utils::construct_variant_value(m_storage, std::forward<T>(val));
+        variant_utils::record_value_construction<U, T>();
+        type_idx = idx;
+    }
+
+    // 参数类型不是任何备选类型时，通过重载决议选出目标类型，并直接用参数原地构造
+    template <
+        typename T,
+        typename U = trait::remove_cvref_t<T>,
+        std::enable_if_t<!std::is_same_v<U, BasicVariant>, int> = 0,
+        std::enable_if_t<(variant_utils::find_idx_by_type<U, Ts...> == -1), int> = 0,
+        std::enable_if_t<!variant_utils::is_variant_subset_v<U, Ts...>, int> = 0,
+        int64_t idx = variant_utils::find_converting_idx<T, Ts...>,
+        std::enable_if_t<(idx != -1), int> = 0>
+    BasicVariant(T &&val)
+    {
+        using type = variant_utils::find_type_by_idx_t<idx, Ts...>;
+        new (&get<idx>()) type(std::forward<T>(val));
+        variant_utils::record_lifecycle<type>(variant_utils::lifecycle_event::construct);
         type_idx = idx;
     }
 
@@ -335,20 +1069,43 @@ public:
     // }
 
 public:
-    Variant(const Variant &other)
+    BasicVariant(const BasicVariant &other)
     {
         construct_from(other);
     }
 
-    Variant(Variant &&other) noexcept
+    BasicVariant(BasicVariant &&other) noexcept
     {
         construct_from(std::move(other));
-        other.type_idx = null_type;
+        other.clear_moved_from();
+    }
+
+    // 无损拓宽：Variant<A, B> -> Variant<A, B, C> / Variant<C, B, A>
+    template <
+        typename UPolicy,
+        typename... Us,
+        std::enable_if_t<!std::is_same_v<BasicVariant<UPolicy, Us...>, BasicVariant> &&
+                             variant_utils::is_variant_subset_v<BasicVariant<UPolicy, Us...>, Ts...>,
+                         int> = 0>
+    BasicVariant(const BasicVariant<UPolicy, Us...> &other)
+    {
+        construct_from_subset(other);
+    }
+
+    template <
+        typename UPolicy,
+        typename... Us,
+        std::enable_if_t<!std::is_same_v<BasicVariant<UPolicy, Us...>, BasicVariant> &&
+                             variant_utils::is_variant_subset_v<BasicVariant<UPolicy, Us...>, Ts...>,
+                         int> = 0>
+    BasicVariant(BasicVariant<UPolicy, Us...> &&other) noexcept
+    {
+        construct_from_subset(std::move(other));
     }
 
-    ~Variant()
+    ~BasicVariant()
     {
-        if constexpr (!is_all_trivially_destructible)
+        if constexpr (!is_all_trivially_destructible || variant_utils::lifecycle_stats_enabled)
             destroy();
     }
 
@@ -356,24 +1113,118 @@ public:
     template <
         typename T,
         typename U = trait::remove_cvref_t<T>,
-        std::enable_if_t<!std::is_same_v<U, Variant>, int> = 0,
+        std::enable_if_t<!std::is_same_v<U, BasicVariant>, int> = 0,
         std::enable_if_t<(variant_utils::find_idx_by_type<U, Ts...> != -1), int> = 0>
-    Variant &operator=(T &&val)
+    BasicVariant &operator=(T &&val)
     {
+        constexpr auto idx = variant_utils::find_idx_by_type<U, Ts...>;
+
+        if constexpr (std::is_assignable_v<U &, T &&>)
+        {
+            if (type_idx == idx)
+            {
+                record_same_type_assign(idx);
+                get<idx>() = std::forward<T>(val);
+                return *this;
+            }
+        }
+
+        // 永不为空模式下构造可能抛出时，先在临时对象上构造，避免留下已析构的值
+        if constexpr (never_empty && !std::is_nothrow_constructible_v<U, T &&>)
+            return *this = U(std::forward<T>(val));
+
         destroy();
-        type_idx = null_type;
+        if constexpr (!never_empty)
+            type_idx = null_type;
 
-        constexpr auto idx = variant_utils::find_idx_by_type<U, Ts...>;
         variant_utils::construct_variant_value(m_storage, std::forward<T>(val));
+        variant_utils::record_value_construction<U, T>();
         type_idx = idx;
         return *this;
     }
 
-    Variant &operator=(const Variant &other)
+    template <
+        typename T,
+        typename U = trait::remove_cvref_t<T>,
+        std::enable_if_t<!std::is_same_v<U, BasicVariant>, int> = 0,
+        std::enable_if_t<(variant_utils::find_idx_by_type<U, Ts...> == -1), int> = 0,
+        std::enable_if_t<!variant_utils::is_variant_subset_v<U, Ts...>, int> = 0,
+        int64_t idx = variant_utils::find_converting_idx<T, Ts...>,
+        std::enable_if_t<(idx != -1), int> = 0>
+    BasicVariant &operator=(T &&val)
+    {
+        using type = variant_utils::find_type_by_idx_t<idx, Ts...>;
+
+        if constexpr (std::is_assignable_v<type &, T &&>)
+        {
+            if (type_idx == idx)
+            {
+                record_same_type_assign(idx);
+                get<idx>() = std::forward<T>(val);
+                return *this;
+            }
+        }
+
+        if constexpr (never_empty && !std::is_nothrow_constructible_v<type, T &&>)
+            return *this = type(std::forward<T>(val));
+
+        destroy();
+        if constexpr (!never_empty)
+            type_idx = null_type;
+
+        new (&get<idx>()) type(std::forward<T>(val));
+        variant_utils::record_lifecycle<type>(variant_utils::lifecycle_event::construct);
+        type_idx = idx;
+        return *this;
+    }
+
+    template <
+        typename UPolicy,
+        typename... Us,
+        std::enable_if_t<!std::is_same_v<BasicVariant<UPolicy, Us...>, BasicVariant> &&
+                             variant_utils::is_variant_subset_v<BasicVariant<UPolicy, Us...>, Ts...>,
+                         int> = 0>
+    BasicVariant &operator=(const BasicVariant<UPolicy, Us...> &other)
+    {
+        if constexpr (never_empty && !(std::is_nothrow_copy_constructible_v<Us> && ...))
+            return *this = BasicVariant(other);
+
+        destroy();
+        construct_from_subset(other);
+        return *this;
+    }
+
+    template <
+        typename UPolicy,
+        typename... Us,
+        std::enable_if_t<!std::is_same_v<BasicVariant<UPolicy, Us...>, BasicVariant> &&
+                             variant_utils::is_variant_subset_v<BasicVariant<UPolicy, Us...>, Ts...>,
+                         int> = 0>
+    BasicVariant &operator=(BasicVariant<UPolicy, Us...> &&other) noexcept
+    {
+        destroy();
+        construct_from_subset(std::move(other));
+        return *this;
+    }
+
+    BasicVariant &operator=(const BasicVariant &other)
     {
         if (this == &other)
             return *this;
 
+        if constexpr (is_all_copy_assignable)
+        {
+            if (holds_same_alternative(other))
+            {
+                record_same_type_assign(other.type_idx);
+                dispatch<assign_table>(type_idx, this, other);
+                return *this;
+            }
+        }
+
+        if constexpr (never_empty && !(std::is_nothrow_copy_constructible_v<Ts> && ...))
+            return *this = BasicVariant(other);
+
         destroy();
 
         construct_from(other);
@@ -381,16 +1232,27 @@ public:
         return *this;
     }
 
-    Variant &operator=(Variant &&other) noexcept
+    BasicVariant &operator=(BasicVariant &&other) noexcept
     {
         if (this == &other)
             return *this;
 
+        if constexpr (is_all_move_assignable)
+        {
+            if (holds_same_alternative(other))
+            {
+                record_same_type_assign(other.type_idx);
+                dispatch<move_assign_table>(type_idx, this, std::move(other));
+                other.clear_moved_from();
+                return *this;
+            }
+        }
+
         destroy();
 
         construct_from(std::move(other));
 
-        other.type_idx = null_type;
+        other.clear_moved_from();
 
         return *this;
     }
@@ -407,6 +1269,7 @@ public:
 
         // 使用 get_storage_value 获取具体的值并进行比较
         using type = variant_utils::find_type_by_idx_t<I, Ts...>;
+        variant_utils::record_lifecycle<type>(variant_utils::lifecycle_event::compare);
         if constexpr (trait::is_equality_comparable_v<type>)
             return variant_utils::get_storage_value<I>(self_storage) == variant_utils::get_storage_value<I>(other_storage);
         else
@@ -421,7 +1284,7 @@ public:
 
     constexpr static auto compare_func_table = make_compare_table();
 
-    bool operator==(const Variant &other) const noexcept
+    bool operator==(const BasicVariant &other) const noexcept
     {
         constexpr bool all_types_are_comparable = (trait::is_equality_comparable_v<Ts> && ...);
         static_assert(
@@ -430,9 +1293,10 @@ public:
 
         if (type_idx != other.type_idx)
             return false;
-        if (this->type_idx == null_type)
-            return true;
-        return compare_func_table[type_idx](&this->m_storage, &other.m_storage);
+        if constexpr (!never_empty)
+            if (this->type_idx == null_type)
+                return true;
+        return dispatch<compare_func_table>(type_idx, &this->m_storage, &other.m_storage);
     }
 
     template <typename T> // 注意：这里我们不再需要 U
@@ -440,21 +1304,165 @@ public:
     {
         using U = trait::remove_cvref_t<T>;
 
-        static_assert(
-            trait::is_equality_comparable_v<U>,
-            "The type being compared against Variant must be equality-comparable.");
+        if constexpr (variant_utils::find_idx_by_type<U, Ts...> == -1)
+        {
+            // 数组（如字符串字面量）按指针比较，避免为每种长度各生成一张表
+            if constexpr (std::is_array_v<U>)
+                return compare_with_convertible<std::decay_t<const T &>>(other);
+            else
+                return compare_with_convertible<U>(other);
+        }
+        else
+        {
+            static_assert(
+                trait::is_equality_comparable_v<U>,
+                "The type being compared against Variant must be equality-comparable.");
+
+            if (!holds_alternative<U>())
+                return false;
+
+            constexpr auto idx = variant_utils::find_idx_by_type<U, Ts...>;
+            using type_in_variant = variant_utils::find_type_by_idx_t<idx, Ts...>;
+            static_assert(
+                trait::is_equality_comparable_v<type_in_variant>,
+                "The type held by the Variant is not equality-comparable.");
+
+            variant_utils::record_lifecycle<U>(variant_utils::lifecycle_event::compare);
+            return get<U>() == other;
+        }
+    }
+
+private:
+    // 与非备选类型 U 比较：按当前下标分发，直接调用当前备选类型与 U 之间的 operator==，
+    // 不构造任何临时对象；当前备选类型无法与 U 比较时结果为 false。
+    template <typename U>
+    using hetero_compare_func_type = bool (*)(const void *, const U &);
 
-        if (!holds_alternative<U>())
+    template <size_t I, typename U>
+    static bool hetero_compare_value_func_constructor(const void *storage_ptr, const U &other)
+    {
+        using type = variant_utils::find_type_by_idx_t<I, Ts...>;
+        if constexpr (trait::is_equality_comparable_with_v<type, U>)
+        {
+            const auto &storage = *static_cast<const variant_utils::Storage<Ts...> *>(storage_ptr);
+            variant_utils::record_lifecycle<type>(variant_utils::lifecycle_event::compare);
+            return variant_utils::get_storage_value<I>(storage) == other;
+        }
+        else
             return false;
+    }
 
-        constexpr auto idx = variant_utils::find_idx_by_type<U, Ts...>;
-        using type_in_variant = variant_utils::find_type_by_idx_t<idx, Ts...>;
+    template <typename U, size_t... I>
+    static constexpr std::array<hetero_compare_func_type<U>, sizeof...(Ts)>
+    make_hetero_compare_table_impl(std::index_sequence<I...>) { return {&hetero_compare_value_func_constructor<I, U>...}; }
+
+    template <typename U>
+    constexpr static auto hetero_compare_func_table = make_hetero_compare_table_impl<U>(std::make_index_sequence<sizeof...(Ts)>{});
+
+    template <typename U>
+    bool compare_with_convertible(const U &other) const noexcept
+    {
         static_assert(
-            trait::is_equality_comparable_v<type_in_variant>,
-            "The type held by the Variant is not equality-comparable.");
+            (trait::is_equality_comparable_with_v<Ts, U> || ...),
+            "The type being compared against Variant must be equality-comparable with at least one alternative type.");
 
-        return get<U>() == other;
+        if constexpr (!never_empty)
+            if (type_idx == null_type)
+                return false;
+        return dispatch<hetero_compare_func_table<U>>(type_idx, &m_storage, other);
     }
 };
 
+namespace variant_utils
+{
+    template <typename T>
+    struct is_variant : std::false_type
+    {
+    };
+    template <typename Policy, typename... Ts>
+    struct is_variant<BasicVariant<Policy, Ts...>> : std::true_type
+    {
+    };
+
+    // 把（可能嵌套、含重复类型的）Variant 转换为 Flat。
+    // 每一层嵌套只按该层的下标查一次表，表项直接在结果中构造最终的值，不产生中间 Variant。
+    template <typename Flat>
+    struct flatten_into
+    {
+        template <size_t I, typename Source>
+        static Flat flatten_func_constructor(Source &&source)
+        {
+            auto &value = source.template get<I>();
+            using type = trait::remove_cvref_t<decltype(value)>;
+
+            if constexpr (is_variant<type>::value)
+            {
+                if constexpr (std::is_lvalue_reference_v<Source>)
+                    return apply(value);
+                else
+                    return apply(std::move(value));
+            }
+            else if constexpr (std::is_lvalue_reference_v<Source>)
+                return Flat(value);
+            else
+                return Flat(std::move(value));
+        }
+
+        template <typename Source, size_t... I>
+        static constexpr auto make_flatten_table_impl(std::index_sequence<I...>)
+        {
+            using flatten_func_type = Flat (*)(Source &&);
+            return std::array<flatten_func_type, sizeof...(I)>{&flatten_func_constructor<I, Source>...};
+        }
+
+        template <typename Source>
+        constexpr static auto flatten_table = make_flatten_table_impl<Source>(
+            std::make_index_sequence<trait::remove_cvref_t<Source>::m_size>{});
+
+        template <typename Source>
+        static Flat apply(Source &&source)
+        {
+            if (source.index() == -1)
+                return Flat();
+            return flatten_table<Source>[source.index()](std::forward<Source>(source));
+        }
+    };
+
+    template <typename Policy, typename... Ts>
+    flat_variant_t<Ts...> flatten_variant(const BasicVariant<Policy, Ts...> &source)
+    {
+        return flatten_into<flat_variant_t<Ts...>>::apply(source);
+    }
+
+    template <typename Policy, typename... Ts>
+    flat_variant_t<Ts...> flatten_variant(BasicVariant<Policy, Ts...> &&source)
+    {
+        return flatten_into<flat_variant_t<Ts...>>::apply(std::move(source));
+    }
+
+    // 黄金分割常数按 size_t 的宽度选取，32 位平台上不能直接用 64 位常数初始化 size_t
+    inline size_t hash_combine(size_t seed, size_t value) noexcept
+    {
+        constexpr size_t golden = sizeof(size_t) >= 8 ? static_cast<size_t>(0x9E3779B97F4A7C15ull) : static_cast<size_t>(0x9E3779B9u);
+        return seed ^ (value + golden + (seed << 6) + (seed >> 2));
+    }
+}
+
+// 哈希值同时取决于下标与当前备选值，因此不同位置上的相同类型、相等的值哈希不同；要求每个备选类型都有 std::hash
+namespace std
+{
+    template <typename Policy, typename... Ts>
+    struct hash<BasicVariant<Policy, Ts...>>
+    {
+        size_t operator()(const BasicVariant<Policy, Ts...> &value) const
+        {
+            auto seed = std::hash<int64_t>{}(value.index());
+            if (value.index() == -1)
+                return seed;
+            return variant_utils::hash_combine(seed, value.visit([](const auto &alternative)
+                                                                 { return std::hash<trait::remove_cvref_t<decltype(alternative)>>{}(alternative); }));
+        }
+    };
+}
+
 #endif // INCLUDE_VARIANT
\ No newline at end of file
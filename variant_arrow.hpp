@@ -0,0 +1,394 @@
+#ifndef INCLUDE_VARIANT_ARROW
+#define INCLUDE_VARIANT_ARROW
+
+#include <algorithm>
+#include <cstdlib>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "variant_column.hpp"
+
+// Arrow C Data Interface 的 ABI 定义，与 Arrow 文档中给出的完全一致，
+// 已经包含过 Arrow 头文件时使用同一份定义
+#ifndef ARROW_C_DATA_INTERFACE
+#define ARROW_C_DATA_INTERFACE
+
+#define ARROW_FLAG_DICTIONARY_ORDERED 1
+#define ARROW_FLAG_NULLABLE 2
+#define ARROW_FLAG_MAP_KEYS_NULLABLE 4
+
+struct ArrowSchema
+{
+    const char *format;
+    const char *name;
+    const char *metadata;
+    int64_t flags;
+    int64_t n_children;
+    struct ArrowSchema **children;
+    struct ArrowSchema *dictionary;
+    void (*release)(struct ArrowSchema *);
+    void *private_data;
+};
+
+struct ArrowArray
+{
+    int64_t length;
+    int64_t null_count;
+    int64_t offset;
+    int64_t n_buffers;
+    int64_t n_children;
+    const void **buffers;
+    struct ArrowArray **children;
+    struct ArrowArray *dictionary;
+    void (*release)(struct ArrowArray *);
+    void *private_data;
+};
+
+#endif // ARROW_C_DATA_INTERFACE
+
+// 列式 Variant 与 Arrow union 数组之间的互转：
+//   - dense union：type ids（int8）+ offsets（int32）+ 每个备选类型一个子数组，与 VariantColumns 的布局相同，导出不拷贝数据；
+//   - sparse union：每个子数组与整个数组等长，导出时需要拷贝。
+// 每个备选类型都必须有对应的 Arrow 定长基本类型（见 arrow_format）。Arrow 的 union 没有顶层的空值，含空行的列不能导出。
+namespace variant_utils
+{
+    // 备选类型对应的 Arrow 格式字符串；可为布局相同的自定义类型特化。
+    // bool 在 Arrow 中按位打包，无法零拷贝，因此不提供。
+    template <typename T, typename = void>
+    struct arrow_format
+    {
+        constexpr static const char *value = nullptr;
+    };
+
+    template <typename T>
+    struct arrow_format<T, std::enable_if_t<std::is_integral_v<T> && !std::is_same_v<T, bool>>>
+    {
+        constexpr static const char *value =
+            sizeof(T) == 1   ? (std::is_signed_v<T> ? "c" : "C")
+            : sizeof(T) == 2 ? (std::is_signed_v<T> ? "s" : "S")
+            : sizeof(T) == 4 ? (std::is_signed_v<T> ? "i" : "I")
+            : sizeof(T) == 8 ? (std::is_signed_v<T> ? "l" : "L")
+                             : nullptr;
+    };
+
+    template <>
+    struct arrow_format<float>
+    {
+        constexpr static const char *value = "f";
+    };
+
+    template <>
+    struct arrow_format<double>
+    {
+        constexpr static const char *value = "g";
+    };
+
+    template <typename... Ts>
+    constexpr bool is_arrow_compatible_v = ((arrow_format<Ts>::value != nullptr) && ...);
+
+    enum class arrow_union_mode
+    {
+        dense,
+        sparse
+    };
+
+    // 解析 "+ud:0,1,2" / "+us:0,1,2"，得到模式与各子数组的 type id；type id 重复时失败
+    inline bool parse_arrow_union_format(const char *format, arrow_union_mode &mode, std::vector<int8_t> &type_ids)
+    {
+        if (!format || format[0] != '+' || format[1] != 'u' || (format[2] != 'd' && format[2] != 's') || format[3] != ':')
+            return false;
+        mode = format[2] == 'd' ? arrow_union_mode::dense : arrow_union_mode::sparse;
+        type_ids.clear();
+        const char *p = format + 4;
+        while (*p)
+        {
+            char *next = nullptr;
+            long id = std::strtol(p, &next, 10);
+            if (next == p || id < 0 || id > 127 ||
+                std::find(type_ids.begin(), type_ids.end(), static_cast<int8_t>(id)) != type_ids.end())
+                return false;
+            type_ids.push_back(static_cast<int8_t>(id));
+            p = next;
+            if (*p == ',')
+                ++p;
+            else if (*p)
+                return false;
+        }
+        return true;
+    }
+
+    // 导出结果持有的元数据与缓冲区指针表；被导出的列数据本身不属于它，dense 模式下源列必须比导出的数组活得更久。
+    // 父节点与每个子节点各有一份 private_data，共同引用同一份 shared 状态：
+    // 使用者可以按 C Data Interface 的约定把子节点移走单独持有，父节点释放后子节点的缓冲区仍然有效。
+    struct arrow_export_schema
+    {
+        struct shared
+        {
+            std::string format;
+            std::vector<std::string> names;
+            std::vector<ArrowSchema> children;
+            std::vector<ArrowSchema *> child_ptrs;
+        };
+
+        std::shared_ptr<shared> state;
+
+        // 父子节点共用：先释放仍未被移走的子节点，再释放自己的引用
+        static void release(ArrowSchema *schema)
+        {
+            for (int64_t i = 0; i < schema->n_children; ++i)
+                if (schema->children[i]->release)
+                    schema->children[i]->release(schema->children[i]);
+            delete static_cast<arrow_export_schema *>(schema->private_data);
+            schema->release = nullptr;
+        }
+    };
+
+    struct arrow_export_array
+    {
+        struct shared
+        {
+            std::vector<const void *> buffers;
+            std::vector<std::vector<const void *>> child_buffers;
+            std::vector<ArrowArray> children;
+            std::vector<ArrowArray *> child_ptrs;
+            std::vector<std::vector<char>> sparse_data;
+        };
+
+        std::shared_ptr<shared> state;
+
+        static void release(ArrowArray *array)
+        {
+            for (int64_t i = 0; i < array->n_children; ++i)
+                if (array->children[i]->release)
+                    array->children[i]->release(array->children[i]);
+            delete static_cast<arrow_export_array *>(array->private_data);
+            array->release = nullptr;
+        }
+    };
+
+    // 把列导出为 Arrow union 数组，成功后由调用者（Arrow 一侧）负责调用 release。
+    // 列中含有空行时返回 false，此时不会写入 schema / array。
+    template <typename Derived, typename... Ts>
+    bool export_arrow(const column_access<Derived, Ts...> &source, ArrowSchema *schema, ArrowArray *array,
+                      arrow_union_mode mode = arrow_union_mode::dense)
+    {
+        static_assert(is_arrow_compatible_v<Ts...>, "Every alternative needs an Arrow primitive equivalent, see variant_utils::arrow_format.");
+
+        const auto &columns = static_cast<const Derived &>(source);
+        const auto tags = columns.tags();
+        for (auto tag : tags)
+            if (tag < 0)
+                return false;
+
+        constexpr size_t n = sizeof...(Ts);
+        constexpr std::array<const char *, n> formats = {arrow_format<Ts>::value...};
+        constexpr std::array<size_t, n> sizes = {sizeof(Ts)...};
+        const std::array<ColumnSpan<char>, n> data = {
+            ColumnSpan<char>{reinterpret_cast<const char *>(columns.template column<Ts>().data()), columns.template column<Ts>().size()}...};
+
+        auto s = std::make_shared<arrow_export_schema::shared>();
+        s->format = mode == arrow_union_mode::dense ? "+ud:" : "+us:";
+        s->names.resize(n);
+        s->children.resize(n);
+        s->child_ptrs.resize(n);
+
+        auto a = std::make_shared<arrow_export_array::shared>();
+        a->child_buffers.resize(n);
+        a->children.resize(n);
+        a->child_ptrs.resize(n);
+
+        if (mode == arrow_union_mode::dense)
+            a->buffers = {tags.data(), columns.offsets().data()};
+        else
+        {
+            // sparse：子数组与整个数组等长，未被选中的位置填零
+            a->buffers = {tags.data()};
+            a->sparse_data.resize(n);
+            for (size_t i = 0; i < n; ++i)
+                a->sparse_data[i].assign(tags.size() * sizes[i], 0);
+            const auto offsets = columns.offsets();
+            for (size_t row = 0; row < tags.size(); ++row)
+            {
+                auto i = static_cast<size_t>(tags[row]);
+                std::memcpy(a->sparse_data[i].data() + row * sizes[i], data[i].data() + static_cast<size_t>(offsets[row]) * sizes[i], sizes[i]);
+            }
+        }
+
+        for (size_t i = 0; i < n; ++i)
+        {
+            s->format += (i ? "," : "") + std::to_string(i);
+            s->names[i] = std::to_string(i);
+            s->children[i] = ArrowSchema{formats[i], s->names[i].c_str(), nullptr, ARROW_FLAG_NULLABLE, 0, nullptr, nullptr,
+                                         &arrow_export_schema::release, new arrow_export_schema{s}};
+            s->child_ptrs[i] = &s->children[i];
+
+            const void *values = mode == arrow_union_mode::dense ? static_cast<const void *>(data[i].data()) : a->sparse_data[i].data();
+            auto length = mode == arrow_union_mode::dense ? data[i].size() : tags.size();
+            a->child_buffers[i] = {nullptr, values};
+            a->children[i] = ArrowArray{static_cast<int64_t>(length), 0, 0, 2, 0, a->child_buffers[i].data(), nullptr, nullptr,
+                                        &arrow_export_array::release, new arrow_export_array{a}};
+            a->child_ptrs[i] = &a->children[i];
+        }
+
+        *schema = ArrowSchema{s->format.c_str(), "", nullptr, 0, static_cast<int64_t>(n), s->child_ptrs.data(), nullptr,
+                              &arrow_export_schema::release, new arrow_export_schema{s}};
+        *array = ArrowArray{static_cast<int64_t>(tags.size()), 0, 0, static_cast<int64_t>(a->buffers.size()), static_cast<int64_t>(n),
+                            a->buffers.data(), a->child_ptrs.data(), nullptr, &arrow_export_array::release, new arrow_export_array{a}};
+        return true;
+    }
+
+    // 检查 union 数组自身的缓冲区：dense 为 type ids 与 offsets 两个，sparse 只有 type ids；
+    // offset 与 length 非负且相加不溢出，缓冲区非空时指针不为空（按 C Data Interface，只有大小为 0 的缓冲区可以为空）
+    inline bool check_arrow_union_buffers(const ArrowArray *array, arrow_union_mode mode)
+    {
+        auto buffers = mode == arrow_union_mode::dense ? 2 : 1;
+        if (array->n_buffers != buffers || !array->buffers || array->length < 0 || array->offset < 0 ||
+            array->length > std::numeric_limits<int64_t>::max() - array->offset)
+            return false;
+        if (array->length + array->offset == 0)
+            return true;
+        for (int i = 0; i < buffers; ++i)
+            if (!array->buffers[i])
+                return false;
+        return true;
+    }
+
+    // 检查子数组与 Ts... 一一对应：格式一致、没有空值，得到各子数组第一个元素的地址与长度
+    template <typename... Ts>
+    bool check_arrow_children(const ArrowSchema *schema, const ArrowArray *array, std::array<ColumnSpan<char>, sizeof...(Ts)> &data)
+    {
+        constexpr size_t n = sizeof...(Ts);
+        constexpr std::array<const char *, n> formats = {arrow_format<Ts>::value...};
+        constexpr std::array<size_t, n> sizes = {sizeof(Ts)...};
+
+        if (schema->n_children != static_cast<int64_t>(n) || array->n_children != static_cast<int64_t>(n))
+            return false;
+        for (size_t i = 0; i < n; ++i)
+        {
+            const ArrowSchema *child_schema = schema->children[i];
+            const ArrowArray *child = array->children[i];
+            if (std::strcmp(child_schema->format, formats[i]) != 0 || child->n_buffers != 2 ||
+                child->length < 0 || child->offset < 0 || (child->buffers[0] && child->null_count != 0))
+                return false;
+            if (child->length && !child->buffers[1])
+                return false;
+            data[i] = {static_cast<const char *>(child->buffers[1]) + static_cast<size_t>(child->offset) * sizes[i],
+                       static_cast<size_t>(child->length)};
+        }
+        return true;
+    }
+
+    template <size_t I, typename... Ts>
+    void import_arrow_func_constructor(VariantColumns<Ts...> &out, const char *data, size_t index)
+    {
+        using type = find_type_by_idx_t<I, Ts...>;
+        type value;
+        std::memcpy(&value, data + index * sizeof(type), sizeof(type));
+        out.push_back(value);
+    }
+
+    template <typename... Ts, size_t... I>
+    constexpr auto make_import_arrow_table_impl(std::index_sequence<I...>)
+    {
+        using import_func_type = void (*)(VariantColumns<Ts...> &, const char *, size_t);
+        return std::array<import_func_type, sizeof...(Ts)>{&import_arrow_func_constructor<I, Ts...>...};
+    }
+
+    // 拷贝导入 dense 或 sparse union 数组，追加到 out 末尾；type id 可以是任意排列。
+    // 不接管 schema / array 的所有权，调用者仍需自行 release。格式不匹配或数据越界时返回 false，out 可能已追加部分行。
+    template <typename... Ts>
+    bool import_arrow(const ArrowSchema *schema, const ArrowArray *array, VariantColumns<Ts...> &out)
+    {
+        static_assert(is_arrow_compatible_v<Ts...>, "Every alternative needs an Arrow primitive equivalent, see variant_utils::arrow_format.");
+        constexpr static auto import_table = make_import_arrow_table_impl<Ts...>(std::index_sequence_for<Ts...>{});
+
+        arrow_union_mode mode;
+        std::vector<int8_t> type_ids;
+        std::array<ColumnSpan<char>, sizeof...(Ts)> data;
+        if (!parse_arrow_union_format(schema->format, mode, type_ids) || type_ids.size() != sizeof...(Ts) ||
+            !check_arrow_union_buffers(array, mode) || !check_arrow_children<Ts...>(schema, array, data))
+            return false;
+
+        std::array<int8_t, 128> child_of;
+        child_of.fill(-1);
+        for (size_t i = 0; i < type_ids.size(); ++i)
+            child_of[type_ids[i]] = static_cast<int8_t>(i);
+
+        const auto *tags = static_cast<const int8_t *>(array->buffers[0]) + array->offset;
+        const auto *offsets = mode == arrow_union_mode::dense ? static_cast<const int32_t *>(array->buffers[1]) + array->offset : nullptr;
+        out.reserve(out.size() + static_cast<size_t>(array->length));
+        for (int64_t row = 0; row < array->length; ++row)
+        {
+            auto tag = tags[row];
+            if (tag < 0 || child_of[tag] == -1)
+                return false;
+            auto i = static_cast<size_t>(child_of[tag]);
+            auto index = offsets ? static_cast<int64_t>(offsets[row]) : row + array->offset;
+            if (index < 0 || static_cast<size_t>(index) >= data[i].size())
+                return false;
+            import_table[i](out, data[i].data(), static_cast<size_t>(index));
+        }
+        return true;
+    }
+
+    // 零拷贝导入 dense union 数组：直接引用 Arrow 的缓冲区，type id 必须是 0, 1, ..., n - 1。
+    // 打开时会检查一遍 type ids 与 offsets，之后的访问不再检查。
+    // 不接管所有权，在调用 release 之前使用。
+    template <typename... Ts>
+    class ArrowVariantColumns : public column_access<ArrowVariantColumns<Ts...>, Ts...>
+    {
+    private:
+        ColumnSpan<int8_t> m_tags;
+        ColumnSpan<int32_t> m_offsets;
+        std::array<ColumnSpan<char>, sizeof...(Ts)> m_data{};
+
+    public:
+        static_assert(is_arrow_compatible_v<Ts...>, "Every alternative needs an Arrow primitive equivalent, see variant_utils::arrow_format.");
+
+        bool open(const ArrowSchema *schema, const ArrowArray *array)
+        {
+            *this = ArrowVariantColumns();
+
+            arrow_union_mode mode;
+            std::vector<int8_t> type_ids;
+            std::array<ColumnSpan<char>, sizeof...(Ts)> data;
+            if (!parse_arrow_union_format(schema->format, mode, type_ids) || mode != arrow_union_mode::dense ||
+                type_ids.size() != sizeof...(Ts) || !check_arrow_union_buffers(array, mode) || !check_arrow_children<Ts...>(schema, array, data))
+                return false;
+            for (size_t i = 0; i < type_ids.size(); ++i)
+                if (type_ids[i] != static_cast<int8_t>(i))
+                    return false;
+
+            auto rows = static_cast<size_t>(array->length);
+            ColumnSpan<int8_t> tags{static_cast<const int8_t *>(array->buffers[0]) + array->offset, rows};
+            ColumnSpan<int32_t> offsets{static_cast<const int32_t *>(array->buffers[1]) + array->offset, rows};
+            for (size_t row = 0; row < rows; ++row)
+                if (tags[row] < 0 || static_cast<size_t>(tags[row]) >= sizeof...(Ts) ||
+                    offsets[row] < 0 || static_cast<size_t>(offsets[row]) >= data[tags[row]].size())
+                    return false;
+
+            m_tags = tags;
+            m_offsets = offsets;
+            m_data = data;
+            return true;
+        }
+
+        size_t size() const noexcept { return m_tags.size(); }
+
+        ColumnSpan<int8_t> tags() const noexcept { return m_tags; }
+        ColumnSpan<int32_t> offsets() const noexcept { return m_offsets; }
+
+        template <size_t I>
+        auto column() const noexcept
+        {
+            using type = find_type_by_idx_t<I, Ts...>;
+            return ColumnSpan<type>{reinterpret_cast<const type *>(m_data[I].data()), m_data[I].size()};
+        }
+
+        using column_access<ArrowVariantColumns, Ts...>::column;
+    };
+}
+
+#endif // INCLUDE_VARIANT_ARROW
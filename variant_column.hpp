@@ -0,0 +1,141 @@
+#ifndef INCLUDE_VARIANT_COLUMN
+#define INCLUDE_VARIANT_COLUMN
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <tuple>
+#include <vector>
+
+#include "variant.hpp"
+#include "variant_ref.hpp"
+
+// 列式存储（与 Arrow dense union 相同的布局）：
+//   - tags：每行一个 int8_t，为该行的备选下标，-1 表示空 Variant；
+//   - offsets：每行一个 int32_t，为该行的值在对应备选列中的位置；
+//   - 每个备选类型一列，按出现顺序紧密存放该类型的所有值。
+// 只支持平凡可拷贝的备选类型。写成列文件后可以直接 mmap 使用，无需解析，见 variant_column_file.hpp。
+// 偏移量与 Arrow 一致为 int32_t，因此每个备选列最多 2^31 - 1 个值（总行数不受此限制）。
+namespace variant_utils
+{
+    // 一段连续的只读列数据，begin / end 即可顺序扫描
+    template <typename T>
+    struct ColumnSpan
+    {
+        const T *m_data{nullptr};
+        size_t m_size{0};
+
+        const T *data() const noexcept { return m_data; }
+        size_t size() const noexcept { return m_size; }
+        const T *begin() const noexcept { return m_data; }
+        const T *end() const noexcept { return m_data + m_size; }
+        const T &operator[](size_t i) const noexcept { return m_data[i]; }
+    };
+
+    // 两种列存储共用的访问接口，Derived 需提供 tags()、offsets() 与 column<I>()
+    template <typename Derived, typename... Ts>
+    class column_access
+    {
+    public:
+        static_assert(sizeof...(Ts) <= 127, "Variant columns use int8_t tags and support at most 127 alternatives.");
+        static_assert((std::is_trivially_copyable_v<Ts> && ...), "Variant columns require trivially copyable alternative types.");
+
+    private:
+        const Derived &self() const noexcept { return static_cast<const Derived &>(*this); }
+
+        template <size_t I>
+        static VariantView<Ts...> row_func_constructor(const Derived &columns, size_t offset) noexcept
+        {
+            return VariantView<Ts...>(columns.template column<I>()[offset]);
+        }
+
+        template <size_t... I>
+        static constexpr auto make_row_table_impl(std::index_sequence<I...>)
+        {
+            using row_func_type = VariantView<Ts...> (*)(const Derived &, size_t) noexcept;
+            return std::array<row_func_type, sizeof...(Ts)>{&row_func_constructor<I>...};
+        }
+
+        constexpr static auto row_table = make_row_table_impl(std::index_sequence_for<Ts...>{});
+
+    public:
+        template <typename T>
+        auto column() const noexcept
+        {
+            constexpr auto id = find_idx_by_type<T, Ts...>;
+            static_assert(id != -1);
+            return self().template column<static_cast<size_t>(id)>();
+        }
+
+        // 第 row 行的只读视图，指向对应备选列中的元素；空行得到空视图
+        VariantView<Ts...> operator[](size_t row) const noexcept
+        {
+            auto tag = self().tags()[row];
+            if (tag < 0)
+                return VariantView<Ts...>();
+            return row_table[tag](self(), static_cast<size_t>(self().offsets()[row]));
+        }
+    };
+
+    // 内存中的列式 Variant 数组，同时也是列文件的写入端
+    template <typename... Ts>
+    class VariantColumns : public variant_utils::column_access<VariantColumns<Ts...>, Ts...>
+    {
+    private:
+        std::vector<int8_t> m_tags;
+        std::vector<int32_t> m_offsets;
+        std::tuple<std::vector<Ts>...> m_columns;
+
+        template <size_t I>
+        void push_alternative(const find_type_by_idx_t<I, Ts...> &value)
+        {
+            auto &column = std::get<I>(m_columns);
+            if (column.size() > static_cast<size_t>(std::numeric_limits<int32_t>::max()))
+                throw std::length_error("VariantColumns: an alternative column exceeds int32_t offsets");
+            m_tags.push_back(static_cast<int8_t>(I));
+            m_offsets.push_back(static_cast<int32_t>(column.size()));
+            column.push_back(value);
+        }
+
+    public:
+        template <
+            typename T,
+            std::enable_if_t<(find_idx_by_type<T, Ts...> != -1), int> = 0>
+        void push_back(const T &value) { push_alternative<find_idx_by_type<T, Ts...>>(value); }
+
+        void push_back(const Variant<Ts...> &value)
+        {
+            if (value.index() == -1)
+            {
+                m_tags.push_back(-1);
+                m_offsets.push_back(0);
+                return;
+            }
+            value.visit([this](const auto &alternative)
+                        { push_back(alternative); });
+        }
+
+        void reserve(size_t rows)
+        {
+            m_tags.reserve(rows);
+            m_offsets.reserve(rows);
+        }
+
+        size_t size() const noexcept { return m_tags.size(); }
+
+        ColumnSpan<int8_t> tags() const noexcept { return {m_tags.data(), m_tags.size()}; }
+        ColumnSpan<int32_t> offsets() const noexcept { return {m_offsets.data(), m_offsets.size()}; }
+
+        template <size_t I>
+        auto column() const noexcept
+        {
+            const auto &column = std::get<I>(m_columns);
+            return ColumnSpan<find_type_by_idx_t<I, Ts...>>{column.data(), column.size()};
+        }
+
+        using column_access<VariantColumns, Ts...>::column;
+    };
+}
+
+#endif // INCLUDE_VARIANT_COLUMN
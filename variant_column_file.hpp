@@ -0,0 +1,293 @@
+#ifndef INCLUDE_VARIANT_COLUMN_FILE
+#define INCLUDE_VARIANT_COLUMN_FILE
+
+#include <algorithm>
+#include <cstdio>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "variant_column.hpp"
+
+// VariantColumns 的列文件：write_columns 写出，MappedVariantColumns 以 mmap 只读打开。
+// 读取端依赖 POSIX 的 mmap，只应在 POSIX 平台上包含本头文件。
+namespace variant_utils
+{
+    // 列文件格式（本机字节序）：
+    //     column_file_header | column_file_entry[sizeof...(Ts)] | tags | offsets | 各备选列
+    // 每一段都从 column_file_alignment 字节对齐的位置开始。
+    constexpr uint32_t column_file_magic = 0x4C4F4356; // "VCOL"
+    constexpr uint32_t column_file_version = 2;
+    constexpr uint32_t column_file_byte_order = 0x01020304;
+    constexpr uint64_t column_file_alignment = 64;
+
+    struct column_file_header
+    {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t byte_order;
+        uint32_t alternatives;
+        uint64_t rows;
+        uint64_t tags_offset;
+        uint64_t offsets_offset;
+    };
+
+    struct column_file_entry
+    {
+        uint64_t offset;
+        uint64_t count;
+        uint32_t element_size;
+        uint32_t element_align;
+        uint64_t type_id;
+    };
+
+    // 编译器给出的带类型名的函数签名的 FNV-1a 哈希，只在同一编译器内稳定
+    template <typename T>
+    constexpr uint64_t column_type_name_hash() noexcept
+    {
+#if defined(_MSC_VER)
+        const char *name = __FUNCSIG__;
+#else
+        const char *name = __PRETTY_FUNCTION__;
+#endif
+        uint64_t hash = 0xcbf29ce484222325;
+        for (; *name; ++name)
+            hash = (hash ^ static_cast<unsigned char>(*name)) * 0x100000001b3;
+        return hash;
+    }
+
+    // 写入列文件的备选类型指纹，打开时与 Ts... 逐一比较，避免把 <int32_t, float> 的文件当作 <float, int32_t> 读取。
+    // 算术类型由类别与大小决定，跨编译器稳定；其他类型使用类型名的哈希，需要跨编译器交换文件时可为其特化。
+    template <typename T, typename = void>
+    struct column_type_id
+    {
+        constexpr static uint64_t value = column_type_name_hash<T>();
+    };
+
+    template <typename T>
+    struct column_type_id<T, std::enable_if_t<std::is_arithmetic_v<T>>>
+    {
+        constexpr static uint64_t kind = std::is_same_v<T, bool> ? 'b' : std::is_floating_point_v<T> ? 'f' : std::is_signed_v<T> ? 'i' : 'u';
+        constexpr static uint64_t value = kind << 8 | sizeof(T);
+    };
+
+    inline uint64_t align_column_offset(uint64_t offset) noexcept
+    {
+        return (offset + column_file_alignment - 1) / column_file_alignment * column_file_alignment;
+    }
+
+    // 把列写入文件；失败时返回 false
+    template <typename... Ts>
+    bool write_columns(const char *path, const VariantColumns<Ts...> &columns)
+    {
+        std::FILE *file = std::fopen(path, "wb");
+        if (!file)
+            return false;
+
+        uint64_t position = 0;
+        bool ok = true;
+        auto write_at = [&](uint64_t offset, const void *data, size_t bytes)
+        {
+            static const char zeros[column_file_alignment] = {};
+            while (ok && position < offset)
+            {
+                auto pad = static_cast<size_t>(std::min<uint64_t>(offset - position, sizeof(zeros)));
+                ok = std::fwrite(zeros, 1, pad, file) == pad;
+                position += pad;
+            }
+            if (ok && bytes)
+                ok = std::fwrite(data, 1, bytes, file) == bytes;
+            position += bytes;
+        };
+
+        column_file_header header{};
+        header.magic = column_file_magic;
+        header.version = column_file_version;
+        header.byte_order = column_file_byte_order;
+        header.alternatives = sizeof...(Ts);
+        header.rows = columns.size();
+
+        uint64_t offset = sizeof(column_file_header) + sizeof(column_file_entry) * sizeof...(Ts);
+        header.tags_offset = offset = align_column_offset(offset);
+        offset += columns.size() * sizeof(int8_t);
+        header.offsets_offset = offset = align_column_offset(offset);
+        offset += columns.size() * sizeof(int32_t);
+
+        std::array<column_file_entry, sizeof...(Ts)> entries{};
+        size_t i = 0;
+        ((entries[i] = {offset = align_column_offset(offset), columns.template column<Ts>().size(), sizeof(Ts), alignof(Ts), column_type_id<Ts>::value},
+          offset += columns.template column<Ts>().size() * sizeof(Ts), ++i),
+         ...);
+
+        write_at(0, &header, sizeof(header));
+        write_at(position, entries.data(), sizeof(column_file_entry) * entries.size());
+        write_at(header.tags_offset, columns.tags().data(), columns.size() * sizeof(int8_t));
+        write_at(header.offsets_offset, columns.offsets().data(), columns.size() * sizeof(int32_t));
+        i = 0;
+        ((write_at(entries[i].offset, columns.template column<Ts>().data(), columns.template column<Ts>().size() * sizeof(Ts)), ++i), ...);
+
+        return (std::fclose(file) == 0) && ok;
+    }
+
+    // 以 mmap 只读方式打开列文件。open 只校验文件头与各列的类型、范围，不扫描数据，耗时与行数无关；
+    // 各段按需由操作系统分页载入，只扫描某一备选列时不会触碰其它列。
+    // operator[] 在访问时检查该行的标签与偏移量，遇到损坏的行抛出 std::out_of_range；
+    // 直接使用 tags() / offsets() 处理不可信的文件之前，可以先调用 verify() 检查全部行。
+    template <typename... Ts>
+    class MappedVariantColumns : public variant_utils::column_access<MappedVariantColumns<Ts...>, Ts...>
+    {
+    private:
+        void *m_base{nullptr};
+        size_t m_length{0};
+        const column_file_header *m_header{nullptr};
+        const column_file_entry *m_entries{nullptr};
+
+        template <typename T>
+        const T *at(uint64_t offset) const noexcept { return reinterpret_cast<const T *>(static_cast<const char *>(m_base) + offset); }
+
+        bool in_bounds(uint64_t offset, uint64_t count, uint64_t size) const noexcept
+        {
+            return offset <= m_length && count <= (m_length - offset) / size;
+        }
+
+        bool validate() const noexcept
+        {
+            if (m_length < sizeof(column_file_header) + sizeof(column_file_entry) * sizeof...(Ts))
+                return false;
+            const auto &h = *m_header;
+            if (h.magic != column_file_magic || h.version != column_file_version ||
+                h.byte_order != column_file_byte_order || h.alternatives != sizeof...(Ts))
+                return false;
+            if (!in_bounds(h.tags_offset, h.rows, sizeof(int8_t)) || !in_bounds(h.offsets_offset, h.rows, sizeof(int32_t)))
+                return false;
+
+            if (h.offsets_offset % alignof(int32_t) != 0)
+                return false;
+
+            constexpr std::array<size_t, sizeof...(Ts)> sizes = {sizeof(Ts)...};
+            constexpr std::array<size_t, sizeof...(Ts)> aligns = {alignof(Ts)...};
+            constexpr std::array<uint64_t, sizeof...(Ts)> type_ids = {column_type_id<Ts>::value...};
+            for (size_t i = 0; i < sizeof...(Ts); ++i)
+            {
+                const auto &e = m_entries[i];
+                if (e.element_size != sizes[i] || e.element_align != aligns[i] || e.type_id != type_ids[i] ||
+                    e.offset % aligns[i] != 0 || !in_bounds(e.offset, e.count, sizes[i]))
+                    return false;
+            }
+            return true;
+        }
+
+        // 第 row 行的标签与偏移量是否指向对应列内的值
+        bool valid_row(size_t row) const noexcept
+        {
+            auto tag = tags()[row];
+            if (tag == -1)
+                return true;
+            auto offset = offsets()[row];
+            return tag >= 0 && static_cast<size_t>(tag) < sizeof...(Ts) && offset >= 0 &&
+                   static_cast<uint64_t>(offset) < m_entries[tag].count;
+        }
+
+    public:
+        MappedVariantColumns() = default;
+        MappedVariantColumns(const MappedVariantColumns &) = delete;
+        MappedVariantColumns &operator=(const MappedVariantColumns &) = delete;
+
+        MappedVariantColumns(MappedVariantColumns &&other) noexcept { *this = std::move(other); }
+
+        MappedVariantColumns &operator=(MappedVariantColumns &&other) noexcept
+        {
+            if (this == &other)
+                return *this;
+            close();
+            std::swap(m_base, other.m_base);
+            std::swap(m_length, other.m_length);
+            std::swap(m_header, other.m_header);
+            std::swap(m_entries, other.m_entries);
+            return *this;
+        }
+
+        ~MappedVariantColumns() { close(); }
+
+        // 打开失败（文件不存在、格式或类型列表不匹配）时返回 false
+        bool open(const char *path) noexcept
+        {
+            close();
+
+            int fd = ::open(path, O_RDONLY);
+            if (fd < 0)
+                return false;
+            struct stat st;
+            if (::fstat(fd, &st) != 0 || st.st_size <= 0)
+            {
+                ::close(fd);
+                return false;
+            }
+            m_length = static_cast<size_t>(st.st_size);
+            void *base = ::mmap(nullptr, m_length, PROT_READ, MAP_SHARED, fd, 0);
+            ::close(fd);
+            if (base == MAP_FAILED)
+            {
+                m_length = 0;
+                return false;
+            }
+
+            m_base = base;
+            m_header = at<column_file_header>(0);
+            m_entries = at<column_file_entry>(sizeof(column_file_header));
+            if (!validate())
+            {
+                close();
+                return false;
+            }
+            return true;
+        }
+
+        void close() noexcept
+        {
+            if (m_base)
+                ::munmap(m_base, m_length);
+            m_base = nullptr;
+            m_length = 0;
+            m_header = nullptr;
+            m_entries = nullptr;
+        }
+
+        bool is_open() const noexcept { return m_base != nullptr; }
+
+        size_t size() const noexcept { return m_header ? static_cast<size_t>(m_header->rows) : 0; }
+
+        // 扫描全部行，确认每一行都指向有效的值；需要读取所有标签与偏移量，耗时与行数成正比
+        bool verify() const noexcept
+        {
+            for (size_t row = 0; row < size(); ++row)
+                if (!valid_row(row))
+                    return false;
+            return true;
+        }
+
+        VariantView<Ts...> operator[](size_t row) const
+        {
+            if (!valid_row(row))
+                throw std::out_of_range("MappedVariantColumns: corrupt tag or offset in column file");
+            return column_access<MappedVariantColumns, Ts...>::operator[](row);
+        }
+
+        ColumnSpan<int8_t> tags() const noexcept { return {at<int8_t>(m_header->tags_offset), size()}; }
+        ColumnSpan<int32_t> offsets() const noexcept { return {at<int32_t>(m_header->offsets_offset), size()}; }
+
+        template <size_t I>
+        auto column() const noexcept
+        {
+            using type = find_type_by_idx_t<I, Ts...>;
+            const auto &entry = m_entries[I];
+            return ColumnSpan<type>{at<type>(entry.offset), static_cast<size_t>(entry.count)};
+        }
+
+        using column_access<MappedVariantColumns, Ts...>::column;
+    };
+}
+
+#endif // INCLUDE_VARIANT_COLUMN_FILE
@@ -0,0 +1,144 @@
+#ifndef INCLUDE_VARIANT_COW
+#define INCLUDE_VARIANT_COW
+
+#include <atomic>
+
+#include "variant.hpp"
+
+namespace variant_utils
+{
+    // Cow<T> 的引用计数是否为原子操作；只在单线程内共享的类型可以特化为 false，省掉原子指令
+    template <typename T>
+    struct cow_policy
+    {
+        constexpr static bool atomic_refcount = true;
+    };
+
+    template <bool atomic>
+    struct cow_refcount
+    {
+        std::atomic<size_t> count{1};
+
+        void acquire() noexcept { count.fetch_add(1, std::memory_order_relaxed); }
+        bool release() noexcept { return count.fetch_sub(1, std::memory_order_acq_rel) == 1; }
+        size_t load() const noexcept { return count.load(std::memory_order_acquire); }
+    };
+
+    template <>
+    struct cow_refcount<false>
+    {
+        size_t count{1};
+
+        void acquire() noexcept { ++count; }
+        bool release() noexcept { return --count == 0; }
+        size_t load() const noexcept { return count; }
+    };
+}
+
+// 写时复制的备选类型：拷贝只增加引用计数，多个 Cow 共享同一份不可变的值；
+// 通过非 const 的 operator* / operator-> / write() 访问时，若值仍被共享，先复制出独占的一份（分离）再返回。
+// 只读访问请通过 const 对象或 read()，以免无谓地分离。移动后源对象为空。
+// 引用计数是否为原子操作默认由 variant_utils::cow_policy<T> 决定，单独某处也可以直接写 Cow<T, false>。
+template <typename T, bool atomic = variant_utils::cow_policy<T>::atomic_refcount>
+class Cow
+{
+private:
+    struct payload
+    {
+        variant_utils::cow_refcount<atomic> refs;
+        T value;
+
+        template <typename... Args>
+        explicit payload(Args &&...args) : value(std::forward<Args>(args)...) {}
+    };
+
+    payload *m_ptr{nullptr};
+
+    void drop() noexcept
+    {
+        if (m_ptr && m_ptr->refs.release())
+            delete m_ptr;
+        m_ptr = nullptr;
+    }
+
+    void detach()
+    {
+        if (m_ptr && m_ptr->refs.load() != 1)
+        {
+            auto *copy = new payload(m_ptr->value);
+            drop();
+            m_ptr = copy;
+        }
+    }
+
+public:
+    Cow(const T &value) : m_ptr(new payload(value)) {}
+    Cow(T &&value) : m_ptr(new payload(std::move(value))) {}
+
+    template <typename... Args>
+    explicit Cow(std::in_place_t, Args &&...args) : m_ptr(new payload(std::forward<Args>(args)...)) {}
+
+    Cow(const Cow &other) noexcept : m_ptr(other.m_ptr)
+    {
+        if (m_ptr)
+            m_ptr->refs.acquire();
+    }
+
+    Cow(Cow &&other) noexcept : m_ptr(other.m_ptr) { other.m_ptr = nullptr; }
+
+    Cow &operator=(const Cow &other) noexcept
+    {
+        if (m_ptr == other.m_ptr)
+            return *this;
+        if (other.m_ptr)
+            other.m_ptr->refs.acquire();
+        drop();
+        m_ptr = other.m_ptr;
+        return *this;
+    }
+
+    Cow &operator=(Cow &&other) noexcept
+    {
+        if (this == &other)
+            return *this;
+        drop();
+        m_ptr = other.m_ptr;
+        other.m_ptr = nullptr;
+        return *this;
+    }
+
+    ~Cow() { drop(); }
+
+public:
+    const T &read() const noexcept { return m_ptr->value; }
+
+    T &write()
+    {
+        detach();
+        return m_ptr->value;
+    }
+
+    const T &operator*() const noexcept { return read(); }
+    const T *operator->() const noexcept { return &read(); }
+    T &operator*() { return write(); }
+    T *operator->() { return &write(); }
+
+    // 共享同一份值的 Cow 个数，被移动之后为 0
+    size_t use_count() const noexcept { return m_ptr ? m_ptr->refs.load() : 0; }
+
+    explicit operator bool() const noexcept { return m_ptr != nullptr; }
+
+    // 共享同一份值时不必逐个比较
+    bool operator==(const Cow &other) const
+    {
+        if (m_ptr == other.m_ptr)
+            return true;
+        if (!m_ptr || !other.m_ptr)
+            return false;
+        return m_ptr->value == other.m_ptr->value;
+    }
+
+    bool operator!=(const Cow &other) const { return !(*this == other); }
+};
+
+#endif // INCLUDE_VARIANT_COW
@@ -0,0 +1,138 @@
+#ifndef INCLUDE_VARIANT_EXEC
+#define INCLUDE_VARIANT_EXEC
+
+#include <vector>
+
+#include "variant.hpp"
+
+// 依次执行一段 Variant 序列，例如以 Variant<Push, Pop, Add, Jump, ...> 表示指令的字节码解释器。
+// 对序列中的每个元素调用 f：
+//   - f(value, pc) 返回下一个要执行的位置，可以实现跳转；返回值不小于序列长度时停止；
+//   - f 不接受 pc 时调用 f(value)，然后顺序执行下一个元素。
+// 返回停止时的位置。序列中的元素不能为空，最多支持 switch_dispatch_limit 个备选类型。
+//
+// threaded_execute 在 GCC / Clang 上使用 labels-as-values：每个备选类型的处理代码末尾
+// 直接按下一个元素的下标跳转到对应的处理代码（threaded code），每种备选类型各有一个间接跳转点，
+// 分支预测器可以分别学习“某条指令之后通常是哪条指令”；其他编译器上退化为 switch_execute。
+// switch_execute 是普通的 while + switch 循环，所有元素共用一个间接跳转点。
+namespace variant_utils
+{
+    template <size_t I, typename V, typename F>
+    inline size_t exec_step(const V *code, size_t pc, F &f)
+    {
+        const auto &value = code[pc].template get<I>();
+        if constexpr (std::is_invocable_v<F &, decltype(value), size_t>)
+            return f(value, pc);
+        else
+        {
+            f(value);
+            return pc + 1;
+        }
+    }
+
+#define VARIANT_EXEC_CASE(H, L)                                                            \
+    case (H) * 8 + (L):                                                                    \
+        if constexpr ((H) * 8 + (L) < sizeof...(Ts))                                       \
+            pc = exec_step<(H) * 8 + (L)>(code, pc, f);                                    \
+        else                                                                               \
+            VARIANT_UNREACHABLE();                                                         \
+        break;
+#define VARIANT_EXEC_CASES_8(H)                                                                          \
+    VARIANT_EXEC_CASE(H, 0) VARIANT_EXEC_CASE(H, 1) VARIANT_EXEC_CASE(H, 2) VARIANT_EXEC_CASE(H, 3)     \
+    VARIANT_EXEC_CASE(H, 4) VARIANT_EXEC_CASE(H, 5) VARIANT_EXEC_CASE(H, 6) VARIANT_EXEC_CASE(H, 7)
+
+    template <typename Policy, typename... Ts, typename F>
+    size_t switch_execute(const BasicVariant<Policy, Ts...> *code, size_t size, F &&f, size_t pc = 0)
+    {
+        static_assert(sizeof...(Ts) <= switch_dispatch_limit, "switch_execute supports at most switch_dispatch_limit alternatives.");
+        while (pc < size)
+        {
+            switch (code[pc].index())
+            {
+                VARIANT_EXEC_CASES_8(0)
+                VARIANT_EXEC_CASES_8(1)
+                VARIANT_EXEC_CASES_8(2)
+                VARIANT_EXEC_CASES_8(3)
+                VARIANT_EXEC_CASES_8(4)
+                VARIANT_EXEC_CASES_8(5)
+                VARIANT_EXEC_CASES_8(6)
+                VARIANT_EXEC_CASES_8(7)
+            default:
+                VARIANT_UNREACHABLE();
+            }
+        }
+        return pc;
+    }
+
+#undef VARIANT_EXEC_CASES_8
+#undef VARIANT_EXEC_CASE
+
+#if defined(__GNUC__) || defined(__clang__)
+    // labels-as-values 是 GNU 扩展，在 -Wpedantic 下会对每个 &&label 和 goto * 报警，这里有意使用，局部关闭
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpedantic"
+    // 标签在函数作用域，if constexpr 的分支内不能有标签，因此只把调用放在 if constexpr 中
+#define VARIANT_EXEC_LABEL(H, L)                                                           \
+    exec_label_##H##_##L:                                                                  \
+    if constexpr ((H) * 8 + (L) < sizeof...(Ts))                                           \
+        pc = exec_step<(H) * 8 + (L)>(code, pc, f);                                        \
+    else                                                                                   \
+        VARIANT_UNREACHABLE();                                                             \
+    if (pc >= size)                                                                        \
+        return pc;                                                                         \
+    goto *labels[code[pc].index()];
+#define VARIANT_EXEC_LABELS_8(H)                                                                          \
+    VARIANT_EXEC_LABEL(H, 0) VARIANT_EXEC_LABEL(H, 1) VARIANT_EXEC_LABEL(H, 2) VARIANT_EXEC_LABEL(H, 3)     \
+    VARIANT_EXEC_LABEL(H, 4) VARIANT_EXEC_LABEL(H, 5) VARIANT_EXEC_LABEL(H, 6) VARIANT_EXEC_LABEL(H, 7)
+#define VARIANT_EXEC_ADDRESSES_8(H)                                                        \
+    &&exec_label_##H##_0, &&exec_label_##H##_1, &&exec_label_##H##_2, &&exec_label_##H##_3, \
+        &&exec_label_##H##_4, &&exec_label_##H##_5, &&exec_label_##H##_6, &&exec_label_##H##_7
+
+    template <typename Policy, typename... Ts, typename F>
+    size_t threaded_execute(const BasicVariant<Policy, Ts...> *code, size_t size, F &&f, size_t pc = 0)
+    {
+        static_assert(sizeof...(Ts) <= switch_dispatch_limit, "threaded_execute supports at most switch_dispatch_limit alternatives.");
+        static void *const labels[] = {
+            VARIANT_EXEC_ADDRESSES_8(0), VARIANT_EXEC_ADDRESSES_8(1), VARIANT_EXEC_ADDRESSES_8(2), VARIANT_EXEC_ADDRESSES_8(3),
+            VARIANT_EXEC_ADDRESSES_8(4), VARIANT_EXEC_ADDRESSES_8(5), VARIANT_EXEC_ADDRESSES_8(6), VARIANT_EXEC_ADDRESSES_8(7)};
+
+        if (pc >= size)
+            return pc;
+        goto *labels[code[pc].index()];
+
+        VARIANT_EXEC_LABELS_8(0)
+        VARIANT_EXEC_LABELS_8(1)
+        VARIANT_EXEC_LABELS_8(2)
+        VARIANT_EXEC_LABELS_8(3)
+        VARIANT_EXEC_LABELS_8(4)
+        VARIANT_EXEC_LABELS_8(5)
+        VARIANT_EXEC_LABELS_8(6)
+        VARIANT_EXEC_LABELS_8(7)
+    }
+
+#undef VARIANT_EXEC_ADDRESSES_8
+#undef VARIANT_EXEC_LABELS_8
+#undef VARIANT_EXEC_LABEL
+#pragma GCC diagnostic pop
+#else
+    template <typename Policy, typename... Ts, typename F>
+    size_t threaded_execute(const BasicVariant<Policy, Ts...> *code, size_t size, F &&f, size_t pc = 0)
+    {
+        return switch_execute(code, size, std::forward<F>(f), pc);
+    }
+#endif
+
+    template <typename Policy, typename... Ts, typename F>
+    size_t threaded_execute(const std::vector<BasicVariant<Policy, Ts...>> &code, F &&f, size_t pc = 0)
+    {
+        return threaded_execute(code.data(), code.size(), std::forward<F>(f), pc);
+    }
+
+    template <typename Policy, typename... Ts, typename F>
+    size_t switch_execute(const std::vector<BasicVariant<Policy, Ts...>> &code, F &&f, size_t pc = 0)
+    {
+        return switch_execute(code.data(), code.size(), std::forward<F>(f), pc);
+    }
+}
+
+#endif // INCLUDE_VARIANT_EXEC
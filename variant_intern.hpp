@@ -0,0 +1,232 @@
+#ifndef INCLUDE_VARIANT_INTERN
+#define INCLUDE_VARIANT_INTERN
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <new>
+#include <optional>
+#include <stdexcept>
+#include <vector>
+
+#include "variant.hpp"
+
+namespace variant_utils
+{
+    // 把 std::hash 的结果再打散一次（MurmurHash3 的 fmix64），
+    // 许多标准库对整数的 std::hash 是恒等映射，高位几乎不变，不能直接用来选分片
+    inline uint64_t mix_hash(uint64_t h) noexcept
+    {
+        h ^= h >> 33;
+        h *= 0xFF51AFD7ED558CCDull;
+        h ^= h >> 33;
+        h *= 0xC4CEB9FE1A85EC53ull;
+        h ^= h >> 33;
+        return h;
+    }
+}
+
+// 哈希合并（interning）池：相等的值只保存一份，每个值对应一个 32 位 id，
+// 比较两个已合并的值只需比较 id（或 get_ptr 返回的指针）。
+//   - 按哈希的高位分成 shard_count 个分片，每个分片一把锁、一张开放寻址表，不同分片上的插入互不阻塞；
+//   - 表中每项 8 字节：哈希的低 32 位与分片内的序号，扩容时不需要重新计算哈希；
+//   - 值按序号存放在大小成倍增长的段中，永不移动，因此 get / get_ptr 不加锁，返回的引用 / 指针在池销毁前一直有效。
+// 值只增不减；要求备选类型可比较相等且有 std::hash。
+template <typename... Ts>
+class VariantInterner
+{
+public:
+    using value_type = Variant<Ts...>;
+    using id_type = uint32_t;
+
+    constexpr static unsigned shard_bits = 6;
+    constexpr static size_t shard_count = size_t{1} << shard_bits;
+    constexpr static unsigned local_bits = 32 - shard_bits;
+    constexpr static size_t max_per_shard = size_t{1} << local_bits;
+
+private:
+    // 第 k 段存放序号 [first_segment * (2^k - 1), first_segment * (2^(k+1) - 1))
+    constexpr static unsigned first_segment_bits = 6;
+    constexpr static size_t first_segment = size_t{1} << first_segment_bits;
+    constexpr static size_t segment_count = local_bits - first_segment_bits + 1;
+
+    struct alignas(64) shard
+    {
+        mutable std::mutex mutex;
+        std::vector<uint64_t> slots;
+        size_t size{0};
+        std::array<std::atomic<value_type *>, segment_count> segments{};
+    };
+
+    std::array<shard, shard_count> m_shards;
+
+    static size_t segment_of(size_t local) noexcept
+    {
+#if defined(__GNUC__) || defined(__clang__)
+        return static_cast<size_t>(63 - __builtin_clzll(local + first_segment)) - first_segment_bits;
+#else
+        size_t k = 0;
+        while (((local + first_segment) >> (first_segment_bits + k + 1)) != 0)
+            ++k;
+        return k;
+#endif
+    }
+
+    static size_t segment_begin(size_t k) noexcept { return first_segment * ((size_t{1} << k) - 1); }
+
+    static value_type *value_at(const shard &s, size_t local) noexcept
+    {
+        auto k = segment_of(local);
+        return s.segments[k].load(std::memory_order_acquire) + (local - segment_begin(k));
+    }
+
+    static id_type make_id(size_t shard_idx, size_t local) noexcept
+    {
+        return static_cast<id_type>((local << shard_bits) | shard_idx);
+    }
+
+    // 在 s 中查找 value，找到时返回表项位置与序号；未找到时返回应插入的空位
+    static std::pair<size_t, std::optional<size_t>> probe(const shard &s, uint32_t fragment, const value_type &value)
+    {
+        auto mask = s.slots.size() - 1;
+        for (size_t pos = fragment & mask;; pos = (pos + 1) & mask)
+        {
+            auto slot = s.slots[pos];
+            if (slot == 0)
+                return {pos, std::nullopt};
+            if (static_cast<uint32_t>(slot >> 32) == fragment)
+            {
+                auto local = static_cast<size_t>(slot & 0xFFFFFFFF) - 1;
+                if (*value_at(s, local) == value)
+                    return {pos, local};
+            }
+        }
+    }
+
+    static void grow(shard &s)
+    {
+        std::vector<uint64_t> slots(s.slots.empty() ? 64 : s.slots.size() * 2, 0);
+        auto mask = slots.size() - 1;
+        for (auto slot : s.slots)
+        {
+            if (slot == 0)
+                continue;
+            auto pos = static_cast<size_t>(slot >> 32) & mask;
+            while (slots[pos] != 0)
+                pos = (pos + 1) & mask;
+            slots[pos] = slot;
+        }
+        s.slots.swap(slots);
+    }
+
+    template <typename V>
+    id_type insert(V &&value)
+    {
+        auto h = variant_utils::mix_hash(std::hash<value_type>{}(value));
+        auto shard_idx = static_cast<size_t>(h >> (64 - shard_bits));
+        auto fragment = static_cast<uint32_t>(h);
+        auto &s = m_shards[shard_idx];
+
+        std::lock_guard<std::mutex> lock(s.mutex);
+        if ((s.size + 1) * 2 > s.slots.size())
+            grow(s);
+        auto [pos, found] = probe(s, fragment, value);
+        if (found)
+            return make_id(shard_idx, *found);
+
+        auto local = s.size;
+        if (local >= max_per_shard)
+            throw std::length_error("VariantInterner: shard is full");
+        auto k = segment_of(local);
+        auto *segment = s.segments[k].load(std::memory_order_relaxed);
+        if (!segment)
+        {
+            segment = static_cast<value_type *>(::operator new(sizeof(value_type) * (first_segment << k), std::align_val_t{alignof(value_type)}));
+            s.segments[k].store(segment, std::memory_order_release);
+        }
+        new (segment + (local - segment_begin(k))) value_type(std::forward<V>(value));
+
+        s.slots[pos] = (uint64_t{fragment} << 32) | (local + 1);
+        ++s.size;
+        return make_id(shard_idx, local);
+    }
+
+public:
+    VariantInterner() = default;
+    VariantInterner(const VariantInterner &) = delete;
+    VariantInterner &operator=(const VariantInterner &) = delete;
+
+    ~VariantInterner()
+    {
+        for (auto &s : m_shards)
+        {
+            for (size_t k = 0; k < segment_count; ++k)
+            {
+                auto *segment = s.segments[k].load(std::memory_order_relaxed);
+                if (!segment)
+                    break;
+                auto count = std::min(first_segment << k, s.size - std::min(s.size, segment_begin(k)));
+                for (size_t i = 0; i < count; ++i)
+                    segment[i].~value_type();
+                ::operator delete(segment, std::align_val_t{alignof(value_type)});
+            }
+        }
+    }
+
+    // 返回与 value 相等的值的 id，不存在时插入一份
+    id_type intern(const value_type &value) { return insert(value); }
+    id_type intern(value_type &&value) { return insert(std::move(value)); }
+
+    // 只查找，不插入
+    std::optional<id_type> find(const value_type &value) const
+    {
+        auto h = variant_utils::mix_hash(std::hash<value_type>{}(value));
+        auto shard_idx = static_cast<size_t>(h >> (64 - shard_bits));
+        const auto &s = m_shards[shard_idx];
+
+        std::lock_guard<std::mutex> lock(s.mutex);
+        if (s.slots.empty())
+            return std::nullopt;
+        auto found = probe(s, static_cast<uint32_t>(h), value).second;
+        if (!found)
+            return std::nullopt;
+        return make_id(shard_idx, *found);
+    }
+
+    // id 必须来自本池；不加锁
+    const value_type &get(id_type id) const noexcept
+    {
+        return *value_at(m_shards[id & (shard_count - 1)], id >> shard_bits);
+    }
+
+    const value_type *get_ptr(id_type id) const noexcept { return &get(id); }
+
+    const value_type *intern_ptr(const value_type &value) { return get_ptr(intern(value)); }
+
+    size_t size() const
+    {
+        size_t n = 0;
+        for (auto &s : m_shards)
+        {
+            std::lock_guard<std::mutex> lock(s.mutex);
+            n += s.size;
+        }
+        return n;
+    }
+
+    // 池自身占用的字节数：哈希表与值的存储段（不含值内部另行分配的内存，如长字符串）
+    size_t memory_usage() const
+    {
+        size_t bytes = sizeof(*this);
+        for (auto &s : m_shards)
+        {
+            std::lock_guard<std::mutex> lock(s.mutex);
+            bytes += s.slots.capacity() * sizeof(uint64_t);
+            for (size_t k = 0; k < segment_count && s.segments[k].load(std::memory_order_relaxed); ++k)
+                bytes += sizeof(value_type) * (first_segment << k);
+        }
+        return bytes;
+    }
+};
+
+#endif // INCLUDE_VARIANT_INTERN
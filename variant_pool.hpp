@@ -0,0 +1,379 @@
+#ifndef INCLUDE_VARIANT_POOL
+#define INCLUDE_VARIANT_POOL
+
+#include <atomic>
+#include <new>
+#include <thread>
+
+#include "variant.hpp"
+
+// 为存放在堆上的备选类型（Box<T>，包括递归类型）提供的内存池。
+// 内存按 chunk_size 对齐的块向系统申请，块头记录所属的池，因此释放时只凭地址就能找到池；
+// 块内按 16 字节起、2 的幂的大小分级，每级一个空闲链表，分配和释放都是 O(1) 且不加锁。
+// 池只能在创建它的线程上分配；在其他线程上释放（例如 Variant 经过工作队列传给另一个线程后销毁）是安全的：
+// 这样的块被无锁地压入所在块头的远程释放链表，池在需要新块之前把它们收回。
+class VariantPool
+{
+public:
+    constexpr static size_t chunk_size = size_t{1} << 16;
+    constexpr static size_t min_block = 16;
+    constexpr static size_t max_block = 4096;
+    constexpr static size_t size_classes = 9;
+
+    constexpr static size_t size_class(size_t bytes) noexcept
+    {
+        size_t c = 0;
+        while ((min_block << c) < bytes)
+            ++c;
+        return c;
+    }
+
+    // 能否从池中分配
+    template <typename T>
+    constexpr static bool is_poolable_v = sizeof(T) <= max_block && alignof(T) <= min_block;
+
+private:
+    struct free_block
+    {
+        free_block *next;
+        size_t size_class; // 只在远程释放链表中使用
+    };
+
+    // remote 为其他线程释放的块组成的链表；块与池脱离后置为 orphaned，
+    // 此后所有释放都改为原子地减少 orphan_live，减到 0 的线程把整块交还系统
+    constexpr static uintptr_t orphaned = 1;
+
+    struct chunk_header
+    {
+        VariantPool *owner;       // 以下三项只由所属线程访问
+        chunk_header *next;
+        size_t live;
+        std::thread::id thread;   // 所属线程，在块被分配出去之前写入
+        std::atomic<uintptr_t> remote{0};
+        std::atomic<size_t> orphan_live{0};
+    };
+
+    std::array<free_block *, size_classes> m_free{};
+    chunk_header *m_chunks{nullptr};
+    chunk_header *m_spare{nullptr};
+    char *m_cursor{nullptr};
+    char *m_limit{nullptr};
+    std::thread::id m_thread{std::this_thread::get_id()};
+
+    inline static thread_local VariantPool *t_current{nullptr};
+
+    static chunk_header *chunk_of(void *ptr) noexcept
+    {
+        return reinterpret_cast<chunk_header *>(reinterpret_cast<uintptr_t>(ptr) & ~(uintptr_t{chunk_size} - 1));
+    }
+
+    static void free_chunk(chunk_header *chunk) noexcept
+    {
+        chunk->~chunk_header();
+        ::operator delete(static_cast<void *>(chunk), std::align_val_t{chunk_size});
+    }
+
+    // 与池脱离的块上的一次释放；最后一个对象释放时交还系统
+    static void release_orphan(chunk_header *chunk, size_t count) noexcept
+    {
+        if (chunk->orphan_live.fetch_sub(count, std::memory_order_acq_rel) == count)
+            free_chunk(chunk);
+    }
+
+    // 把 chunk 上其他线程释放的块放回空闲链表，返回收回的个数
+    size_t drain_remote(chunk_header *chunk) noexcept
+    {
+        auto head = chunk->remote.exchange(0, std::memory_order_acquire);
+        size_t count = 0;
+        for (auto *block = reinterpret_cast<free_block *>(head); block;)
+        {
+            auto *next = block->next;
+            block->next = m_free[block->size_class];
+            m_free[block->size_class] = block;
+            block = next;
+            ++count;
+        }
+        chunk->live -= count;
+        return count;
+    }
+
+    void new_chunk()
+    {
+        // 先收回其他线程释放的块，有可用的块时不必申请新块
+        bool reclaimed = false;
+        for (auto *chunk = m_chunks; chunk; chunk = chunk->next)
+            reclaimed |= drain_remote(chunk) != 0;
+        if (reclaimed)
+            return;
+
+        auto *memory = m_spare;
+        if (memory)
+        {
+            m_spare = memory->next;
+            memory->~chunk_header();
+        }
+        else
+            memory = static_cast<chunk_header *>(::operator new(chunk_size, std::align_val_t{chunk_size}));
+        auto *chunk = new (memory) chunk_header{this, m_chunks, 0, m_thread};
+        m_chunks = chunk;
+        m_cursor = reinterpret_cast<char *>(chunk) + (sizeof(chunk_header) + min_block - 1) / min_block * min_block;
+        m_limit = reinterpret_cast<char *>(chunk) + chunk_size;
+    }
+
+    static void deallocate_remote(chunk_header *chunk, void *ptr, size_t bytes) noexcept
+    {
+        auto *block = static_cast<free_block *>(ptr);
+        block->size_class = size_class(bytes);
+        auto head = chunk->remote.load(std::memory_order_relaxed);
+        do
+        {
+            if (head == orphaned)
+                return release_orphan(chunk, 1);
+            block->next = reinterpret_cast<free_block *>(head);
+        } while (!chunk->remote.compare_exchange_weak(head, reinterpret_cast<uintptr_t>(block),
+                                                      std::memory_order_release, std::memory_order_relaxed));
+    }
+
+public:
+    VariantPool() = default;
+    VariantPool(const VariantPool &) = delete;
+    VariantPool &operator=(const VariantPool &) = delete;
+
+    ~VariantPool() { release(); }
+
+    void *allocate(size_t bytes)
+    {
+        auto c = size_class(bytes);
+        if (free_block *block = m_free[c])
+        {
+            m_free[c] = block->next;
+            ++chunk_of(block)->live;
+            return block;
+        }
+
+        auto block_size = min_block << c;
+        if (static_cast<size_t>(m_limit - m_cursor) < block_size)
+        {
+            new_chunk();
+            if (m_free[c])
+                return allocate(bytes);
+            if (static_cast<size_t>(m_limit - m_cursor) < block_size)
+                new_chunk();
+        }
+        void *block = m_cursor;
+        m_cursor += block_size;
+        ++chunk_of(block)->live;
+        return block;
+    }
+
+    // 归还到分配它的池；在其他线程上调用时放入远程释放链表。
+    // 池已经 reset / release 时，块中最后一个对象释放后整块交还系统
+    static void deallocate(void *ptr, size_t bytes) noexcept
+    {
+        auto *chunk = chunk_of(ptr);
+        if (chunk->thread != std::this_thread::get_id())
+            return deallocate_remote(chunk, ptr, bytes);
+
+        if (VariantPool *owner = chunk->owner)
+        {
+            --chunk->live;
+            auto c = size_class(bytes);
+            auto *block = static_cast<free_block *>(ptr);
+            block->next = owner->m_free[c];
+            owner->m_free[c] = block;
+        }
+        else
+            release_orphan(chunk, 1);
+    }
+
+    // 一次性丢弃池中全部分配，空闲的块留作之后的分配，不交还系统；适合每帧 / 每个请求结束时调用。
+    // 仍有存活对象的块不会被复用，而是与池脱离，等其中的对象全部销毁后再交还系统，
+    // 因此 reset / release 之后、甚至池销毁之后再销毁 Box 也是安全的。
+    void reset() noexcept
+    {
+        for (auto *chunk = m_chunks; chunk;)
+        {
+            auto *next = chunk->next;
+            // 标记为脱离的同时取走已到达的远程释放，之后的远程释放都走 orphan_live
+            auto head = chunk->remote.exchange(orphaned, std::memory_order_acq_rel);
+            for (auto *block = reinterpret_cast<free_block *>(head); block; block = block->next)
+                --chunk->live;
+
+            chunk->owner = nullptr;
+            if (chunk->live == 0)
+            {
+                chunk->next = m_spare;
+                m_spare = chunk;
+            }
+            else
+                // 在此之前的远程释放已先把 orphan_live 减成“负数”，加上剩余个数后恰好为 0 时由这里交还
+                release_orphan(chunk, static_cast<size_t>(0) - chunk->live);
+            chunk = next;
+        }
+        m_chunks = nullptr;
+        m_free = {};
+        m_cursor = m_limit = nullptr;
+    }
+    // 与 reset 相同，但同时把空闲的块交还系统
+    void release() noexcept
+    {
+        reset();
+        while (m_spare)
+        {
+            auto *next = m_spare->next;
+            free_chunk(m_spare);
+            m_spare = next;
+        }
+    }
+
+    // 当前线程上新的 Box 从哪个池分配；默认是线程自己的池，可用 VariantPoolScope 临时替换
+    static VariantPool &current() noexcept
+    {
+        if (!t_current)
+        {
+            thread_local VariantPool local;
+            t_current = &local;
+        }
+        return *t_current;
+    }
+
+    friend class VariantPoolScope;
+};
+
+// 在作用域内让当前线程的 Box 从 pool 分配，例如把池的生命周期绑定到一次请求或一帧
+class VariantPoolScope
+{
+private:
+    VariantPool *m_previous;
+
+public:
+    explicit VariantPoolScope(VariantPool &pool) noexcept : m_previous(&VariantPool::current())
+    {
+        VariantPool::t_current = &pool;
+    }
+
+    VariantPoolScope(const VariantPoolScope &) = delete;
+    VariantPoolScope &operator=(const VariantPoolScope &) = delete;
+
+    ~VariantPoolScope() { VariantPool::t_current = m_previous; }
+};
+
+namespace variant_utils
+{
+    // Box<T> 的内存来源，可为某个备选类型特化以接入自己的分配器。
+    // 默认：放得进池的类型使用 VariantPool::current()，其余类型使用 operator new。
+    template <typename T, typename = void>
+    struct box_allocator
+    {
+        static void *allocate()
+        {
+            if constexpr (VariantPool::is_poolable_v<T>)
+                return VariantPool::current().allocate(sizeof(T));
+            else
+                return ::operator new(sizeof(T), std::align_val_t{alignof(T)});
+        }
+
+        static void deallocate(void *ptr) noexcept
+        {
+            if constexpr (VariantPool::is_poolable_v<T>)
+                VariantPool::deallocate(ptr, sizeof(T));
+            else
+                ::operator delete(ptr, std::align_val_t{alignof(T)});
+        }
+    };
+}
+
+// 把大的或递归的备选类型放到堆上，Variant 中只保存一个指针，例如
+//     struct Node;
+//     using Tree = Variant<int, Box<Node>>;
+//     struct Node { Tree left, right; };
+// Box 具有值语义：拷贝时深拷贝，比较时比较所指的值；移动后源对象为空。声明 Box<T> 时 T 可以是不完整类型。
+template <typename T>
+class Box
+{
+private:
+    T *m_ptr{nullptr};
+
+    template <typename... Args>
+    static T *make(Args &&...args)
+    {
+        void *memory = variant_utils::box_allocator<T>::allocate();
+        try
+        {
+            return new (memory) T(std::forward<Args>(args)...);
+        }
+        catch (...)
+        {
+            variant_utils::box_allocator<T>::deallocate(memory);
+            throw;
+        }
+    }
+
+    void reset() noexcept
+    {
+        if (!m_ptr)
+            return;
+        m_ptr->~T();
+        variant_utils::box_allocator<T>::deallocate(m_ptr);
+        m_ptr = nullptr;
+    }
+
+public:
+    Box(const T &value) : m_ptr(make(value)) {}
+    Box(T &&value) : m_ptr(make(std::move(value))) {}
+
+    template <typename... Args>
+    explicit Box(std::in_place_t, Args &&...args) : m_ptr(make(std::forward<Args>(args)...)) {}
+
+    Box(const Box &other) : m_ptr(other.m_ptr ? make(*other.m_ptr) : nullptr) {}
+    Box(Box &&other) noexcept : m_ptr(other.m_ptr) { other.m_ptr = nullptr; }
+
+    Box &operator=(const Box &other)
+    {
+        if (this == &other)
+            return *this;
+        if (m_ptr && other.m_ptr)
+            *m_ptr = *other.m_ptr;
+        else
+        {
+            T *copy = other.m_ptr ? make(*other.m_ptr) : nullptr;
+            reset();
+            m_ptr = copy;
+        }
+        return *this;
+    }
+
+    Box &operator=(Box &&other) noexcept
+    {
+        if (this == &other)
+            return *this;
+        reset();
+        m_ptr = other.m_ptr;
+        other.m_ptr = nullptr;
+        return *this;
+    }
+
+    ~Box() { reset(); }
+
+public:
+    T &operator*() noexcept { return *m_ptr; }
+    const T &operator*() const noexcept { return *m_ptr; }
+    T *operator->() noexcept { return m_ptr; }
+    const T *operator->() const noexcept { return m_ptr; }
+    T *get() noexcept { return m_ptr; }
+    const T *get() const noexcept { return m_ptr; }
+
+    // 被移动之后为空
+    explicit operator bool() const noexcept { return m_ptr != nullptr; }
+
+    bool operator==(const Box &other) const
+    {
+        if (!m_ptr || !other.m_ptr)
+            return m_ptr == other.m_ptr;
+        return *m_ptr == *other.m_ptr;
+    }
+
+    bool operator!=(const Box &other) const { return !(*this == other); }
+};
+
+#endif // INCLUDE_VARIANT_POOL
@@ -0,0 +1,288 @@
+#ifndef INCLUDE_VARIANT_REF
+#define INCLUDE_VARIANT_REF
+
+#include <memory>
+#include <optional>
+
+#include "variant.hpp"
+
+template <bool is_const, typename... Ts>
+class BasicVariantRef;
+
+template <typename... Ts>
+using VariantRef = BasicVariantRef<false, Ts...>;
+
+template <typename... Ts>
+using VariantView = BasicVariantRef<true, Ts...>;
+
+namespace variant_utils
+{
+    template <typename Target, typename Source>
+    struct narrow;
+
+    // 收窄：Variant<Us...> -> Variant<Ts...>，按源下标查一次表。
+    // 表项在编译期通过 index_remap 得知目标下标，不在子集中的备选类型直接返回空。
+    template <typename Policy, typename... Ts, typename UPolicy, typename... Us>
+    struct narrow<BasicVariant<Policy, Ts...>, BasicVariant<UPolicy, Us...>>
+    {
+        using target_type = BasicVariant<Policy, Ts...>;
+        using remap = index_remap<BasicVariant<UPolicy, Us...>, Ts...>;
+
+        template <size_t I, typename Source>
+        static std::optional<target_type> narrow_func_constructor(Source &&source)
+        {
+            if constexpr (remap::table[I] == -1)
+                return std::nullopt;
+            else if constexpr (std::is_lvalue_reference_v<Source>)
+                return std::optional<target_type>(std::in_place, source.template get<I>());
+            else
+                return std::optional<target_type>(std::in_place, std::move(source.template get<I>()));
+        }
+
+        template <typename Source, size_t... I>
+        static constexpr auto make_narrow_table_impl(std::index_sequence<I...>)
+        {
+            using narrow_func_type = std::optional<target_type> (*)(Source &&);
+            return std::array<narrow_func_type, sizeof...(Us)>{&narrow_func_constructor<I, Source>...};
+        }
+
+        template <typename Source>
+        constexpr static auto narrow_table = make_narrow_table_impl<Source>(std::index_sequence_for<Us...>{});
+
+        template <typename Source>
+        static std::optional<target_type> apply(Source &&source)
+        {
+            if (source.index() == -1)
+                return std::nullopt;
+            return narrow_table<Source>[source.index()](std::forward<Source>(source));
+        }
+    };
+}
+
+// 当前备选类型属于 Target 的类型列表时，拷贝 / 移动出一个 Target，否则返回空
+template <typename Target, typename Policy, typename... Us>
+std::optional<Target> try_narrow(const BasicVariant<Policy, Us...> &source)
+{
+    return variant_utils::narrow<Target, BasicVariant<Policy, Us...>>::apply(source);
+}
+
+// 移出成功后，可为空的源与被移走的 Variant 一样置为空，不可为空的源保留被移走后的值；失败时源保持不变
+template <typename Target, typename Policy, typename... Us>
+std::optional<Target> try_narrow(BasicVariant<Policy, Us...> &&source)
+{
+    auto result = variant_utils::narrow<Target, BasicVariant<Policy, Us...>>::apply(std::move(source));
+    if constexpr (!BasicVariant<Policy, Us...>::never_empty)
+        if (result)
+            source = BasicVariant<Policy, Us...>();
+    return result;
+}
+
+namespace variant_utils
+{
+    // 从 Source 得到的视图是否只读
+    template <typename Source>
+    struct is_const_source : std::is_const<Source>
+    {
+    };
+    template <bool is_const, typename... Ts>
+    struct is_const_source<BasicVariantRef<is_const, Ts...>> : std::bool_constant<is_const>
+    {
+    };
+    template <bool is_const, typename... Ts>
+    struct is_const_source<const BasicVariantRef<is_const, Ts...>> : std::bool_constant<is_const>
+    {
+    };
+
+    // Source 能否不经检查地转为视图：类型列表相同或是子集，且不会丢掉 const
+    template <typename Source, bool is_const, typename... Ts>
+    struct is_ref_source : std::false_type
+    {
+    };
+    template <typename Policy, typename... Us, bool is_const, typename... Ts>
+    struct is_ref_source<BasicVariant<Policy, Us...>, is_const, Ts...>
+        : std::bool_constant<std::is_same_v<type_list<Us...>, type_list<Ts...>> || is_variant_subset_v<Variant<Us...>, Ts...>>
+    {
+    };
+    template <typename Policy, typename... Us, bool is_const, typename... Ts>
+    struct is_ref_source<const BasicVariant<Policy, Us...>, is_const, Ts...>
+        : std::bool_constant<is_const && is_ref_source<Variant<Us...>, is_const, Ts...>::value>
+    {
+    };
+    template <bool source_const, typename... Us, bool is_const, typename... Ts>
+    struct is_ref_source<BasicVariantRef<source_const, Us...>, is_const, Ts...>
+        : std::bool_constant<(is_const || !source_const) && is_ref_source<Variant<Us...>, is_const, Ts...>::value>
+    {
+    };
+    template <bool source_const, typename... Us, bool is_const, typename... Ts>
+    struct is_ref_source<const BasicVariantRef<source_const, Us...>, is_const, Ts...>
+        : is_ref_source<BasicVariantRef<source_const, Us...>, is_const, Ts...>
+    {
+    };
+}
+
+// 不拥有值的 Variant 视图：指向当前备选对象的指针，以及它在 Ts... 中的下标（与 Variant 相同的紧凑标签），可平凡拷贝。
+// VariantRef 可修改被引用的值，VariantView 只读。可以由以下对象构造：
+//   - 类型列表相同或是其子集的 Variant / 视图（拓宽，编译期重映射下标）；
+//   - Ts... 中任意一个类型的左值；
+//   - 更宽的 Variant / 视图，通过 try_narrow_ref，当前备选类型不在 Ts... 中则返回空。
+// 视图与被引用对象共享存储，被引用对象必须比视图活得更久。
+template <bool is_const, typename... Ts>
+class BasicVariantRef
+{
+public:
+    constexpr static auto m_size = sizeof...(Ts);
+    constexpr static auto null_type = -1;
+
+private:
+    using pointer = std::conditional_t<is_const, const void *, void *>;
+
+    template <typename T>
+    using reference = std::conditional_t<is_const, const T &, T &>;
+
+    // 标签与 Variant 一样取能容纳全部下标的最小整数。不借用指针的低位：char 等备选类型没有空闲的对齐位
+    using index_type = variant_utils::index_type_t<sizeof...(Ts)>;
+
+    pointer m_ptr{nullptr};
+    index_type type_idx{null_type};
+
+    BasicVariantRef(pointer ptr, int64_t idx) noexcept : m_ptr(ptr), type_idx(static_cast<index_type>(idx)) {}
+
+    template <bool, typename...>
+    friend class BasicVariantRef;
+
+    template <typename... Rs, typename Source>
+    friend auto try_narrow_ref(Source &source) noexcept;
+
+    // 取出源对象当前备选值的地址与它在源类型列表中的下标
+    template <typename Policy, typename... Us>
+    static std::pair<pointer, int64_t> source_address(BasicVariant<Policy, Us...> &source) noexcept
+    {
+        if (source.index() == null_type)
+            return {nullptr, null_type};
+        return {source.visit([](auto &value) -> pointer
+                             { return std::addressof(value); }),
+                source.index()};
+    }
+
+    template <typename Policy, typename... Us>
+    static std::pair<pointer, int64_t> source_address(const BasicVariant<Policy, Us...> &source) noexcept
+    {
+        if (source.index() == null_type)
+            return {nullptr, null_type};
+        return {source.visit([](const auto &value) -> pointer
+                             { return std::addressof(value); }),
+                source.index()};
+    }
+
+    template <bool source_const, typename... Us>
+    static std::pair<pointer, int64_t> source_address(const BasicVariantRef<source_const, Us...> &source) noexcept
+    {
+        return {source.m_ptr, source.type_idx};
+    }
+
+    template <typename Policy, typename... Us>
+    static constexpr auto remap_of(const BasicVariant<Policy, Us...> &) { return variant_utils::index_remap<Variant<Us...>, Ts...>{}; }
+
+    template <bool source_const, typename... Us>
+    static constexpr auto remap_of(const BasicVariantRef<source_const, Us...> &) { return variant_utils::index_remap<Variant<Us...>, Ts...>{}; }
+
+public:
+    BasicVariantRef() = default;
+
+    template <
+        typename Source,
+        std::enable_if_t<!std::is_same_v<std::remove_const_t<Source>, BasicVariantRef>, int> = 0,
+        std::enable_if_t<variant_utils::is_ref_source<Source, is_const, Ts...>::value, int> = 0>
+    BasicVariantRef(Source &source) noexcept
+    {
+        using remap = decltype(remap_of(source));
+        auto [ptr, idx] = source_address(source);
+        if (idx == null_type)
+            return;
+        m_ptr = ptr;
+        type_idx = static_cast<index_type>(remap::table[idx]);
+    }
+
+    template <
+        typename T,
+        typename U = std::remove_cv_t<T>,
+        std::enable_if_t<(variant_utils::find_idx_by_type<U, Ts...> != -1) && (is_const || !std::is_const_v<T>), int> = 0>
+    BasicVariantRef(T &value) noexcept
+        : m_ptr(std::addressof(value)), type_idx(static_cast<index_type>(variant_utils::find_idx_by_type<U, Ts...>))
+    {
+    }
+
+public:
+    template <size_t idx>
+    auto &get() const noexcept
+    {
+        using type = variant_utils::find_type_by_idx_t<idx, Ts...>;
+        return *static_cast<std::remove_reference_t<reference<type>> *>(m_ptr);
+    }
+
+    template <typename T>
+    auto &get() const noexcept
+    {
+        constexpr auto id = variant_utils::find_idx_by_type<T, Ts...>;
+        static_assert(id != -1);
+        return get<id>();
+    }
+
+    template <size_t id>
+    bool holds_alternative() const noexcept { return id == type_idx; }
+
+    template <typename T>
+    bool holds_alternative() const noexcept
+    {
+        constexpr auto target_idx = variant_utils::find_idx_by_type<trait::remove_cvref_t<T>, Ts...>;
+
+        if constexpr (target_idx == -1)
+            return false;
+        else
+            return type_idx == target_idx;
+    }
+
+    int64_t index() const noexcept { return type_idx; }
+
+private:
+    template <size_t I, typename F>
+    static decltype(auto) visit_func_constructor(F &&f, pointer ptr)
+    {
+        using type = variant_utils::find_type_by_idx_t<I, Ts...>;
+        return std::forward<F>(f)(*static_cast<std::remove_reference_t<reference<type>> *>(ptr));
+    }
+
+    template <typename F, size_t... I>
+    static constexpr auto make_visit_table_impl(std::index_sequence<I...>)
+    {
+        using result_type = decltype(visit_func_constructor<0, F>(std::declval<F>(), nullptr));
+        using visit_func_type = result_type (*)(F &&, pointer);
+        return std::array<visit_func_type, sizeof...(Ts)>{&visit_func_constructor<I, F>...};
+    }
+
+    template <typename F>
+    constexpr static auto visit_table = make_visit_table_impl<F>(std::index_sequence_for<Ts...>{});
+
+public:
+    // 调用前视图不能为空
+    template <typename F>
+    decltype(auto) visit(F &&f) const
+    {
+        return visit_table<F>[type_idx](std::forward<F>(f), m_ptr);
+    }
+};
+
+// 从 Variant 或视图收窄出视图：Source 为 const 时得到 VariantView，否则得到 VariantRef
+template <typename... Ts, typename Source>
+auto try_narrow_ref(Source &source) noexcept
+{
+    using result_type = BasicVariantRef<variant_utils::is_const_source<Source>::value, Ts...>;
+    using remap = decltype(result_type::remap_of(source));
+
+    auto [ptr, idx] = result_type::source_address(source);
+    if (idx == result_type::null_type || remap::table[idx] == -1)
+        return std::optional<result_type>();
+    return std::optional<result_type>(result_type(ptr, remap::table[idx]));
+}
+
+#endif // INCLUDE_VARIANT_REF
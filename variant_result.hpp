@@ -0,0 +1,364 @@
+#ifndef INCLUDE_VARIANT_RESULT
+#define INCLUDE_VARIANT_RESULT
+
+#include <new>
+
+#include "variant.hpp"
+
+#if defined(__GNUC__) || defined(__clang__)
+#define VARIANT_COLD __attribute__((cold, noinline))
+#else
+#define VARIANT_COLD
+#endif
+
+namespace variant_utils
+{
+    // Result<T, E> 的错误值是否放到堆上：默认在 E 比 T 大且超过两个指针时装箱，
+    // 让成功路径上的对象保持 T 的大小；可为具体的 T / E 特化。
+    template <typename T, typename E>
+    struct result_policy
+    {
+        constexpr static bool box_error = sizeof(E) > sizeof(T) && sizeof(E) > 2 * sizeof(void *);
+    };
+
+    // 装箱的错误值，只在失败路径上分配，相关函数都不内联
+    template <typename E>
+    class cold_box
+    {
+    private:
+        E *m_ptr;
+
+        template <typename... Args>
+        VARIANT_COLD static E *make(Args &&...args) { return new E(std::forward<Args>(args)...); }
+
+        VARIANT_COLD static void drop(E *ptr) noexcept { delete ptr; }
+
+    public:
+        template <typename... Args>
+        explicit cold_box(std::in_place_t, Args &&...args) : m_ptr(make(std::forward<Args>(args)...)) {}
+
+        cold_box(const cold_box &other) : m_ptr(make(*other.m_ptr)) {}
+        cold_box(cold_box &&other) noexcept : m_ptr(other.m_ptr) { other.m_ptr = nullptr; }
+        cold_box &operator=(const cold_box &) = delete;
+        cold_box &operator=(cold_box &&) = delete;
+
+        ~cold_box()
+        {
+            if (m_ptr)
+                drop(m_ptr);
+        }
+
+        E &get() noexcept { return *m_ptr; }
+        const E &get() const noexcept { return *m_ptr; }
+    };
+
+    template <typename T>
+    struct is_result : std::false_type
+    {
+    };
+
+    template <typename T>
+    struct is_unexpected : std::false_type
+    {
+    };
+}
+
+// 用于构造失败的 Result，例如 return Unexpected(ParseError{...});
+template <typename E>
+struct Unexpected
+{
+    E error;
+
+    template <typename G, std::enable_if_t<!std::is_same_v<trait::remove_cvref_t<G>, Unexpected>, int> = 0>
+    explicit Unexpected(G &&value) : error(std::forward<G>(value)) {}
+};
+
+namespace variant_utils
+{
+    template <typename E>
+    struct is_unexpected<Unexpected<E>> : std::true_type
+    {
+    };
+}
+
+template <typename E>
+Unexpected(E) -> Unexpected<E>;
+
+// 成功值 T 或错误 E，接口与 C++23 的 std::expected 类似（本仓库基于 C++17）：
+//   - 标签只有 1 个字节，存储直接使用 variant_utils::Storage<T, E>；
+//   - 大的错误值装箱（见 result_policy），对象大小约等于 T；
+//   - 拷贝、移动、析构都只有一个 if，成功分支标记为更可能发生；
+//   - and_then / map / map_error 是普通的内联函数模板，不经过任何函数指针表。
+// value() / error() 不做检查，调用前需确认 has_value()。
+template <typename T, typename E>
+class Result
+{
+public:
+    static_assert(!std::is_void_v<T> && !std::is_reference_v<T> && !std::is_reference_v<E>,
+                  "Result requires object types for both the value and the error.");
+
+    using value_type = T;
+    using error_type = E;
+
+    constexpr static bool boxed_error = variant_utils::result_policy<T, E>::box_error;
+
+private:
+    using error_storage = std::conditional_t<boxed_error, variant_utils::cold_box<E>, E>;
+
+    variant_utils::Storage<T, error_storage> m_storage;
+    bool m_has_value;
+
+    T *value_ptr() noexcept { return &variant_utils::get_storage_value<0>(m_storage); }
+    const T *value_ptr() const noexcept { return &variant_utils::get_storage_value<0>(m_storage); }
+    error_storage *error_ptr() noexcept { return &variant_utils::get_storage_value<1>(m_storage); }
+    const error_storage *error_ptr() const noexcept { return &variant_utils::get_storage_value<1>(m_storage); }
+
+    template <typename... Args>
+    void construct_error(Args &&...args)
+    {
+        if constexpr (boxed_error)
+            new (error_ptr()) error_storage(std::in_place, std::forward<Args>(args)...);
+        else
+            new (error_ptr()) error_storage(std::forward<Args>(args)...);
+    }
+
+    template <typename Other>
+    void construct_from(Other &&other)
+    {
+        if (VARIANT_LIKELY(other.m_has_value))
+            new (value_ptr()) T(std::forward<Other>(other).value_ref());
+        else
+            new (error_ptr()) error_storage(std::forward<Other>(other).error_ref());
+    }
+
+    void destroy() noexcept
+    {
+        if (VARIANT_LIKELY(m_has_value))
+            value_ptr()->~T();
+        else
+            error_ptr()->~error_storage();
+    }
+
+    // 把 old_ptr 处的旧值换成由 args 构造的新值（两者可能位于同一块存储）。
+    // 构造抛出异常时旧值保持不变，Result 仍处于有效状态：
+    //   - 新值可以 noexcept 构造时直接析构旧值再构造；
+    //   - 否则先在临时对象上构造，再 noexcept 移动进来；
+    //   - 都不行时先把旧值移到临时对象中，失败后再移回去。
+    template <typename New, typename Old, typename... Args>
+    static void reinit(New *new_ptr, Old *old_ptr, Args &&...args)
+    {
+        if constexpr (std::is_nothrow_constructible_v<New, Args &&...>)
+        {
+            old_ptr->~Old();
+            new (new_ptr) New(std::forward<Args>(args)...);
+        }
+        else if constexpr (std::is_nothrow_move_constructible_v<New>)
+        {
+            New temp(std::forward<Args>(args)...);
+            old_ptr->~Old();
+            new (new_ptr) New(std::move(temp));
+        }
+        else
+        {
+            static_assert(std::is_nothrow_move_constructible_v<Old>,
+                          "Result assignment requires the value or the error to be nothrow move constructible.");
+            Old backup(std::move(*old_ptr));
+            old_ptr->~Old();
+            try
+            {
+                new (new_ptr) New(std::forward<Args>(args)...);
+            }
+            catch (...)
+            {
+                new (old_ptr) Old(std::move(backup));
+                throw;
+            }
+        }
+    }
+
+    T &value_ref() & { return *value_ptr(); }
+    T &&value_ref() && { return std::move(*value_ptr()); }
+    const T &value_ref() const & { return *value_ptr(); }
+    error_storage &error_ref() & { return *error_ptr(); }
+    error_storage &&error_ref() && { return std::move(*error_ptr()); }
+    const error_storage &error_ref() const & { return *error_ptr(); }
+
+    template <typename, typename>
+    friend class Result;
+
+public:
+    template <
+        typename U = T,
+        std::enable_if_t<std::is_constructible_v<T, U &&> && !std::is_same_v<trait::remove_cvref_t<U>, Result> &&
+                             !variant_utils::is_result<trait::remove_cvref_t<U>>::value &&
+                             !variant_utils::is_unexpected<trait::remove_cvref_t<U>>::value,
+                         int> = 0>
+    Result(U &&value) : m_has_value(true)
+    {
+        new (value_ptr()) T(std::forward<U>(value));
+    }
+
+    template <typename G>
+    Result(const Unexpected<G> &unexpected) : m_has_value(false) { construct_error(unexpected.error); }
+
+    template <typename G>
+    Result(Unexpected<G> &&unexpected) : m_has_value(false) { construct_error(std::move(unexpected.error)); }
+
+    Result(const Result &other) : m_has_value(other.m_has_value) { construct_from(other); }
+    Result(Result &&other) noexcept(std::is_nothrow_move_constructible_v<T> && std::is_nothrow_move_constructible_v<error_storage>)
+        : m_has_value(other.m_has_value) { construct_from(std::move(other)); }
+
+    Result &operator=(const Result &other)
+    {
+        if (this == &other)
+            return *this;
+        if (VARIANT_LIKELY(m_has_value && other.m_has_value))
+            *value_ptr() = *other.value_ptr();
+        else if (other.m_has_value)
+            reinit(value_ptr(), error_ptr(), other.value_ref());
+        else if (m_has_value)
+            reinit(error_ptr(), value_ptr(), other.error_ref());
+        else
+            reinit(error_ptr(), error_ptr(), other.error_ref());
+        m_has_value = other.m_has_value;
+        return *this;
+    }
+
+    Result &operator=(Result &&other) noexcept(std::is_nothrow_move_constructible_v<T> && std::is_nothrow_move_assignable_v<T> &&
+                                               std::is_nothrow_move_constructible_v<error_storage>)
+    {
+        if (this == &other)
+            return *this;
+        if (VARIANT_LIKELY(m_has_value && other.m_has_value))
+            *value_ptr() = std::move(*other.value_ptr());
+        else if (other.m_has_value)
+            reinit(value_ptr(), error_ptr(), std::move(other).value_ref());
+        else if (m_has_value)
+            reinit(error_ptr(), value_ptr(), std::move(other).error_ref());
+        else
+            reinit(error_ptr(), error_ptr(), std::move(other).error_ref());
+        m_has_value = other.m_has_value;
+        return *this;
+    }
+
+    ~Result() { destroy(); }
+
+public:
+    bool has_value() const noexcept { return m_has_value; }
+    explicit operator bool() const noexcept { return m_has_value; }
+
+    T &value() & noexcept { return *value_ptr(); }
+    const T &value() const & noexcept { return *value_ptr(); }
+    T &&value() && noexcept { return std::move(*value_ptr()); }
+
+    E &error() & noexcept
+    {
+        if constexpr (boxed_error)
+            return error_ptr()->get();
+        else
+            return *error_ptr();
+    }
+
+    const E &error() const & noexcept
+    {
+        if constexpr (boxed_error)
+            return error_ptr()->get();
+        else
+            return *error_ptr();
+    }
+
+    E &&error() && noexcept { return std::move(error()); }
+
+    template <typename U>
+    T value_or(U &&fallback) const &
+    {
+        if (VARIANT_LIKELY(m_has_value))
+            return value();
+        return static_cast<T>(std::forward<U>(fallback));
+    }
+
+    T &operator*() & noexcept { return value(); }
+    const T &operator*() const & noexcept { return value(); }
+    T *operator->() noexcept { return value_ptr(); }
+    const T *operator->() const noexcept { return value_ptr(); }
+
+public:
+    // f(T) 返回 Result<U, E>；失败时原样传递错误
+    template <typename F>
+    auto and_then(F &&f) const &
+    {
+        using result_type = trait::remove_cvref_t<decltype(std::forward<F>(f)(value()))>;
+        if (VARIANT_LIKELY(m_has_value))
+            return std::forward<F>(f)(value());
+        return result_type(Unexpected<const E &>{error()});
+    }
+
+    template <typename F>
+    auto and_then(F &&f) &&
+    {
+        using result_type = trait::remove_cvref_t<decltype(std::forward<F>(f)(std::move(value())))>;
+        if (VARIANT_LIKELY(m_has_value))
+            return std::forward<F>(f)(std::move(value()));
+        return result_type(Unexpected<E &&>{std::move(error())});
+    }
+
+    // f(T) 返回 U，结果为 Result<U, E>
+    template <typename F>
+    auto map(F &&f) const &
+    {
+        using result_type = Result<trait::remove_cvref_t<decltype(std::forward<F>(f)(value()))>, E>;
+        if (VARIANT_LIKELY(m_has_value))
+            return result_type(std::forward<F>(f)(value()));
+        return result_type(Unexpected<const E &>{error()});
+    }
+
+    template <typename F>
+    auto map(F &&f) &&
+    {
+        using result_type = Result<trait::remove_cvref_t<decltype(std::forward<F>(f)(std::move(value())))>, E>;
+        if (VARIANT_LIKELY(m_has_value))
+            return result_type(std::forward<F>(f)(std::move(value())));
+        return result_type(Unexpected<E &&>{std::move(error())});
+    }
+
+    // f(E) 返回 G，结果为 Result<T, G>
+    template <typename F>
+    auto map_error(F &&f) const &
+    {
+        using result_type = Result<T, trait::remove_cvref_t<decltype(std::forward<F>(f)(error()))>>;
+        if (VARIANT_LIKELY(m_has_value))
+            return result_type(value());
+        return result_type(Unexpected<decltype(std::forward<F>(f)(error()))>{std::forward<F>(f)(error())});
+    }
+
+    template <typename F>
+    auto map_error(F &&f) &&
+    {
+        using result_type = Result<T, trait::remove_cvref_t<decltype(std::forward<F>(f)(std::move(error())))>>;
+        if (VARIANT_LIKELY(m_has_value))
+            return result_type(std::move(value()));
+        return result_type(Unexpected<decltype(std::forward<F>(f)(std::move(error())))>{std::forward<F>(f)(std::move(error()))});
+    }
+
+public:
+    bool operator==(const Result &other) const
+    {
+        if (m_has_value != other.m_has_value)
+            return false;
+        if (VARIANT_LIKELY(m_has_value))
+            return value() == other.value();
+        return error() == other.error();
+    }
+
+    bool operator!=(const Result &other) const { return !(*this == other); }
+};
+
+namespace variant_utils
+{
+    template <typename T, typename E>
+    struct is_result<Result<T, E>> : std::true_type
+    {
+    };
+}
+
+#endif // INCLUDE_VARIANT_RESULT
@@ -0,0 +1,270 @@
+#ifndef INCLUDE_VARIANT_SERIALIZE
+#define INCLUDE_VARIANT_SERIALIZE
+
+#include <cstring>
+#include <string>
+
+#include "variant.hpp"
+#include "variant_ref.hpp"
+
+// 紧凑的二进制编码：
+//     varint(index + 1) | payload
+// index + 1 为 0 表示空 Variant；备选类型少于 127 个时标签只占 1 个字节。
+// 平凡可拷贝的备选类型按原始字节写入 sizeof(T) 个字节（不填充对齐），
+// 其余类型通过特化 variant_utils::serializer<T> 提供编码方式。
+// 写入函数只向调用者提供的缓冲区追加数据，不做任何分配；缓冲区不足或数据损坏时返回 nullptr。
+namespace variant_utils
+{
+    inline size_t varint_size(uint64_t value) noexcept
+    {
+        size_t n = 1;
+        while (value >= 0x80)
+        {
+            value >>= 7;
+            ++n;
+        }
+        return n;
+    }
+
+    inline char *write_varint(char *out, char *end, uint64_t value) noexcept
+    {
+        do
+        {
+            if (out == end)
+                return nullptr;
+            auto byte = static_cast<uint8_t>(value & 0x7F);
+            value >>= 7;
+            *out++ = static_cast<char>(value ? (byte | 0x80) : byte);
+        } while (value);
+        return out;
+    }
+
+    inline const char *read_varint(const char *in, const char *end, uint64_t &value) noexcept
+    {
+        value = 0;
+        for (unsigned shift = 0; shift < 64; shift += 7)
+        {
+            if (in == end)
+                return nullptr;
+            auto byte = static_cast<uint8_t>(*in++);
+            value |= uint64_t{byte & 0x7Fu} << shift;
+            if (!(byte & 0x80))
+                return in;
+        }
+        return nullptr;
+    }
+
+    // deserialize_view 的结果
+    enum class view_status
+    {
+        ok,         // 得到了指向缓冲区的视图
+        needs_copy, // 数据完好，但当前备选类型不能零拷贝读取（非平凡类型或负载未对齐），应改用 deserialize
+        corrupt,    // 数据损坏或被截断
+    };
+
+    struct view_read
+    {
+        view_status status;
+        // status 为 ok 时是读取结束的位置，否则为 nullptr
+        const char *next;
+    };
+
+    // 单个类型的编码钩子：
+    //     static size_t size(const T &);
+    //     static char *write(char *out, char *end, const T &);
+    //     static const char *read(const char *in, const char *end, T &out);
+    // 反序列化时先默认构造 T 再调用 read，因此非平凡类型需要可默认构造。
+    template <typename T, typename = void>
+    struct serializer;
+
+    template <typename T>
+    struct serializer<T, std::enable_if_t<std::is_trivially_copyable_v<T>>>
+    {
+        constexpr static bool zero_copy = true;
+
+        static size_t size(const T &) noexcept { return sizeof(T); }
+
+        static char *write(char *out, char *end, const T &value) noexcept
+        {
+            if (static_cast<size_t>(end - out) < sizeof(T))
+                return nullptr;
+            std::memcpy(out, &value, sizeof(T));
+            return out + sizeof(T);
+        }
+
+        static const char *read(const char *in, const char *end, T &out) noexcept
+        {
+            if (static_cast<size_t>(end - in) < sizeof(T))
+                return nullptr;
+            std::memcpy(&out, in, sizeof(T));
+            return in + sizeof(T);
+        }
+    };
+
+    template <typename CharT, typename Traits, typename Alloc>
+    struct serializer<std::basic_string<CharT, Traits, Alloc>>
+    {
+        using string_type = std::basic_string<CharT, Traits, Alloc>;
+
+        constexpr static bool zero_copy = false;
+
+        static size_t size(const string_type &value) noexcept
+        {
+            return varint_size(value.size()) + value.size() * sizeof(CharT);
+        }
+
+        static char *write(char *out, char *end, const string_type &value) noexcept
+        {
+            out = write_varint(out, end, value.size());
+            auto bytes = value.size() * sizeof(CharT);
+            if (!out || static_cast<size_t>(end - out) < bytes)
+                return nullptr;
+            std::memcpy(out, value.data(), bytes);
+            return out + bytes;
+        }
+
+        static const char *read(const char *in, const char *end, string_type &out)
+        {
+            uint64_t length = 0;
+            in = read_varint(in, end, length);
+            if (!in || static_cast<uint64_t>(end - in) / sizeof(CharT) < length)
+                return nullptr;
+            out.resize(static_cast<size_t>(length));
+            std::memcpy(out.data(), in, static_cast<size_t>(length) * sizeof(CharT));
+            return in + length * sizeof(CharT);
+        }
+    };
+
+    // 嵌套的 Variant 递归使用同一套编码
+    template <typename Policy, typename... Ts>
+    struct serializer<BasicVariant<Policy, Ts...>>
+    {
+        using variant_type = BasicVariant<Policy, Ts...>;
+
+        constexpr static bool zero_copy = false;
+
+        static size_t size(const variant_type &value) noexcept
+        {
+            size_t n = varint_size(static_cast<uint64_t>(value.index() + 1));
+            if (value.index() != -1)
+                n += value.visit([](const auto &alternative) -> size_t
+                                 { return serializer<trait::remove_cvref_t<decltype(alternative)>>::size(alternative); });
+            return n;
+        }
+
+        static char *write(char *out, char *end, const variant_type &value) noexcept
+        {
+            out = write_varint(out, end, static_cast<uint64_t>(value.index() + 1));
+            if (!out || value.index() == -1)
+                return out;
+            return value.visit([&](const auto &alternative) -> char *
+                               { return serializer<trait::remove_cvref_t<decltype(alternative)>>::write(out, end, alternative); });
+        }
+
+        template <size_t I>
+        static const char *read_func_constructor(const char *in, const char *end, variant_type &out)
+        {
+            using type = find_type_by_idx_t<I, Ts...>;
+            static_assert(std::is_default_constructible_v<type>,
+                          "Deserializing a Variant requires its alternative types to be default constructible.");
+            type value{};
+            in = serializer<type>::read(in, end, value);
+            if (in)
+                out = std::move(value);
+            return in;
+        }
+
+        template <size_t... I>
+        static constexpr auto make_read_table_impl(std::index_sequence<I...>)
+        {
+            using read_func_type = const char *(*)(const char *, const char *, variant_type &);
+            return std::array<read_func_type, sizeof...(Ts)>{&read_func_constructor<I>...};
+        }
+
+        constexpr static auto read_table = make_read_table_impl(std::index_sequence_for<Ts...>{});
+
+        static const char *read(const char *in, const char *end, variant_type &out)
+        {
+            uint64_t tag = 0;
+            in = read_varint(in, end, tag);
+            if (!in || tag > sizeof...(Ts))
+                return nullptr;
+            if (tag == 0)
+            {
+                out = variant_type();
+                return in;
+            }
+            return read_table[tag - 1](in, end, out);
+        }
+
+        template <size_t I>
+        static view_read read_view_func_constructor(const char *in, const char *end, VariantView<Ts...> &out) noexcept
+        {
+            using type = find_type_by_idx_t<I, Ts...>;
+            if constexpr (std::is_trivially_copyable_v<type>)
+            {
+                if (static_cast<size_t>(end - in) < sizeof(type))
+                    return {view_status::corrupt, nullptr};
+                if (reinterpret_cast<uintptr_t>(in) % alignof(type) != 0)
+                    return {view_status::needs_copy, nullptr};
+                out = VariantView<Ts...>(*reinterpret_cast<const type *>(in));
+                return {view_status::ok, in + sizeof(type)};
+            }
+            else
+                return {view_status::needs_copy, nullptr};
+        }
+
+        template <size_t... I>
+        static constexpr auto make_read_view_table_impl(std::index_sequence<I...>)
+        {
+            using read_view_func_type = view_read (*)(const char *, const char *, VariantView<Ts...> &) noexcept;
+            return std::array<read_view_func_type, sizeof...(Ts)>{&read_view_func_constructor<I>...};
+        }
+
+        constexpr static auto read_view_table = make_read_view_table_impl(std::index_sequence_for<Ts...>{});
+
+        static view_read read_view(const char *in, const char *end, VariantView<Ts...> &out) noexcept
+        {
+            uint64_t tag = 0;
+            in = read_varint(in, end, tag);
+            if (!in || tag > sizeof...(Ts))
+                return {view_status::corrupt, nullptr};
+            if (tag == 0)
+            {
+                out = VariantView<Ts...>();
+                return {view_status::ok, in};
+            }
+            return read_view_table[tag - 1](in, end, out);
+        }
+    };
+
+    template <typename Policy, typename... Ts>
+    size_t serialized_size(const BasicVariant<Policy, Ts...> &value) noexcept
+    {
+        return serializer<BasicVariant<Policy, Ts...>>::size(value);
+    }
+
+    // 把 value 追加到 [out, end)，返回写入结束的位置
+    template <typename Policy, typename... Ts>
+    char *serialize(char *out, char *end, const BasicVariant<Policy, Ts...> &value) noexcept
+    {
+        return serializer<BasicVariant<Policy, Ts...>>::write(out, end, value);
+    }
+
+    // 从 [in, end) 解出一个值到 out，返回读取结束的位置
+    template <typename Policy, typename... Ts>
+    const char *deserialize(const char *in, const char *end, BasicVariant<Policy, Ts...> &out)
+    {
+        return serializer<BasicVariant<Policy, Ts...>>::read(in, end, out);
+    }
+
+    // 零拷贝读取：当前备选类型平凡可拷贝且负载在缓冲区中恰好满足对齐时，得到直接指向缓冲区的 VariantView；
+    // 不能零拷贝时返回 needs_copy，调用者应从同一位置改用 deserialize；数据损坏时返回 corrupt。
+    template <typename... Ts>
+    view_read deserialize_view(const char *in, const char *end, VariantView<Ts...> &out) noexcept
+    {
+        return serializer<Variant<Ts...>>::read_view(in, end, out);
+    }
+}
+
+#endif // INCLUDE_VARIANT_SERIALIZE
@@ -0,0 +1,296 @@
+#ifndef INCLUDE_VARIANT_STREAM
+#define INCLUDE_VARIANT_STREAM
+
+#include <algorithm>
+#include <tuple>
+#include <vector>
+
+#include "variant.hpp"
+#include "variant_serialize.hpp"
+
+// 面向重复度很高的 Variant 序列（同一备选类型连续出现、数值缓慢变化）的分块压缩格式。
+// 序列按固定行数切成互相独立的块，每块可以单独解码，便于流水线或并行处理：
+//     varint 行数 | varint 段数 | (varint index + 1, varint 长度) * 段数 | 每个备选类型：varint 字节数, 数据
+// 标签序列做游程编码；每个备选类型的值连续存放，按字（宽度为 alignof(T)，不超过 8 字节）
+// 与同一块中同类型的上一个值做差，zigzag 后写成 varint。空类型不占数据字节。
+// 每块最多 stream_max_block_rows 行。只支持平凡可拷贝的备选类型。
+namespace variant_utils
+{
+    // 单个块的行数上限；空行与空类型不占数据字节，解码时靠它限制一个很短的块能要求的内存
+    constexpr size_t stream_max_block_rows = size_t{1} << 20;
+
+    template <typename T>
+    using delta_word_t =
+        std::conditional_t<alignof(T) >= 8, uint64_t,
+                           std::conditional_t<alignof(T) == 4, uint32_t,
+                                              std::conditional_t<alignof(T) == 2, uint16_t, uint8_t>>>;
+
+    template <typename Word>
+    inline uint64_t zigzag_encode(Word delta) noexcept
+    {
+        using signed_word = std::make_signed_t<Word>;
+        auto value = static_cast<int64_t>(static_cast<signed_word>(delta));
+        return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+    }
+
+    template <typename Word>
+    inline Word zigzag_decode(uint64_t value) noexcept
+    {
+        return static_cast<Word>((value >> 1) ^ (~(value & 1) + 1));
+    }
+
+    inline void append_varint(std::vector<char> &out, uint64_t value)
+    {
+        while (value >= 0x80)
+        {
+            out.push_back(static_cast<char>((value & 0x7F) | 0x80));
+            value >>= 7;
+        }
+        out.push_back(static_cast<char>(value));
+    }
+
+    // 单字节的 varint 占绝大多数，先走快速路径
+    inline const char *read_small_varint(const char *in, const char *end, uint64_t &value) noexcept
+    {
+        if (VARIANT_LIKELY(in != end && !(*in & 0x80)))
+        {
+            value = static_cast<uint8_t>(*in);
+            return in + 1;
+        }
+        return read_varint(in, end, value);
+    }
+
+    template <typename T>
+    struct delta_codec
+    {
+        using word_type = delta_word_t<T>;
+        constexpr static size_t words = std::is_empty_v<T> ? 0 : sizeof(T) / sizeof(word_type);
+
+        static void encode(std::vector<char> &out, const T &value, word_type *previous)
+        {
+            word_type current[words ? words : 1];
+            std::memcpy(current, &value, words * sizeof(word_type));
+            for (size_t w = 0; w < words; ++w)
+            {
+                append_varint(out, zigzag_encode(static_cast<word_type>(current[w] - previous[w])));
+                previous[w] = current[w];
+            }
+        }
+
+        static const char *decode(const char *in, const char *end, T &value, word_type *previous) noexcept
+        {
+            for (size_t w = 0; w < words; ++w)
+            {
+                uint64_t delta;
+                in = read_small_varint(in, end, delta);
+                if (!in)
+                    return nullptr;
+                previous[w] = static_cast<word_type>(previous[w] + zigzag_decode<word_type>(delta));
+            }
+            std::memcpy(&value, previous, words * sizeof(word_type));
+            return in;
+        }
+    };
+
+    // 以块为单位的编码器：push 若干行后调用 flush，把当前块追加到输出末尾。
+    // 行数达到 block_rows 时 push 会自动 flush，因此输出中每块最多 block_rows 行；block_rows 不超过 stream_max_block_rows。
+    template <typename... Ts>
+    class VariantStreamEncoder
+    {
+    public:
+        static_assert((std::is_trivially_copyable_v<Ts> && ...), "Variant stream compression requires trivially copyable alternative types.");
+
+        constexpr static size_t default_block_rows = 4096;
+
+    private:
+        std::vector<char> &m_out;
+        size_t m_block_rows;
+        size_t m_rows{0};
+        std::vector<std::pair<int64_t, uint64_t>> m_runs;
+        std::array<std::vector<char>, sizeof...(Ts)> m_sections;
+        std::tuple<std::array<typename delta_codec<Ts>::word_type, delta_codec<Ts>::words>...> m_previous{};
+
+        template <size_t I>
+        void push_alternative(const find_type_by_idx_t<I, Ts...> &value)
+        {
+            using type = find_type_by_idx_t<I, Ts...>;
+            delta_codec<type>::encode(m_sections[I], value, std::get<I>(m_previous).data());
+        }
+
+        template <size_t... I>
+        void push_value(const Variant<Ts...> &value, std::index_sequence<I...>)
+        {
+            ((value.index() == static_cast<int64_t>(I) ? push_alternative<I>(value.template get<I>()) : void()), ...);
+        }
+
+    public:
+        explicit VariantStreamEncoder(std::vector<char> &out, size_t block_rows = default_block_rows)
+            : m_out(out), m_block_rows(block_rows ? std::min(block_rows, stream_max_block_rows) : default_block_rows)
+        {
+        }
+
+        VariantStreamEncoder(const VariantStreamEncoder &) = delete;
+        VariantStreamEncoder &operator=(const VariantStreamEncoder &) = delete;
+
+        // 析构时写出剩余的行；此时的异常（如内存不足）会被忽略，需要得知错误时请先显式调用 flush()
+        ~VariantStreamEncoder()
+        {
+            try
+            {
+                flush();
+            }
+            catch (...)
+            {
+            }
+        }
+
+        void push(const Variant<Ts...> &value)
+        {
+            if (!m_runs.empty() && m_runs.back().first == value.index())
+                ++m_runs.back().second;
+            else
+                m_runs.emplace_back(value.index(), 1);
+            push_value(value, std::index_sequence_for<Ts...>{});
+
+            if (++m_rows == m_block_rows)
+                flush();
+        }
+
+        // 当前块中尚未写出的行数
+        size_t pending() const noexcept { return m_rows; }
+
+        void flush()
+        {
+            if (m_rows == 0)
+                return;
+
+            append_varint(m_out, m_rows);
+            append_varint(m_out, m_runs.size());
+            for (const auto &[idx, length] : m_runs)
+            {
+                append_varint(m_out, static_cast<uint64_t>(idx + 1));
+                append_varint(m_out, length);
+            }
+            for (auto &section : m_sections)
+            {
+                append_varint(m_out, section.size());
+                m_out.insert(m_out.end(), section.begin(), section.end());
+                section.clear();
+            }
+
+            m_rows = 0;
+            m_runs.clear();
+            m_previous = {};
+        }
+    };
+
+    template <typename... Ts>
+    struct stream_decoder
+    {
+        using variant_type = Variant<Ts...>;
+        using previous_type = std::tuple<std::array<typename delta_codec<Ts>::word_type, delta_codec<Ts>::words>...>;
+
+        // 解出一段 length 个连续的同类型值
+        template <size_t I>
+        static const char *decode_run_func_constructor(const char *in, const char *end, uint64_t length,
+                                                       previous_type &previous, std::vector<variant_type> &out)
+        {
+            using type = find_type_by_idx_t<I, Ts...>;
+            type value;
+            for (uint64_t i = 0; i < length; ++i)
+            {
+                in = delta_codec<type>::decode(in, end, value, std::get<I>(previous).data());
+                if (!in)
+                    return nullptr;
+                out.emplace_back(value);
+            }
+            return in;
+        }
+
+        template <size_t... I>
+        static constexpr auto make_decode_run_table_impl(std::index_sequence<I...>)
+        {
+            using decode_run_func_type = const char *(*)(const char *, const char *, uint64_t, previous_type &, std::vector<variant_type> &);
+            return std::array<decode_run_func_type, sizeof...(Ts)>{&decode_run_func_constructor<I>...};
+        }
+
+        constexpr static auto decode_run_table = make_decode_run_table_impl(std::index_sequence_for<Ts...>{});
+
+        static const char *decode_block(const char *in, const char *end, std::vector<variant_type> &out)
+        {
+            uint64_t rows = 0, run_count = 0;
+            if (!(in = read_varint(in, end, rows)) || rows > stream_max_block_rows ||
+                !(in = read_varint(in, end, run_count)) || run_count > rows)
+                return nullptr;
+
+            const char *runs = in;
+            uint64_t total = 0;
+            for (uint64_t r = 0; r < run_count; ++r)
+            {
+                uint64_t tag = 0, length = 0;
+                if (!(in = read_varint(in, end, tag)) || !(in = read_varint(in, end, length)) || tag > sizeof...(Ts) ||
+                    length > rows - total)
+                    return nullptr;
+                total += length;
+            }
+            if (total != rows)
+                return nullptr;
+
+            // 定位每个备选类型的数据段
+            std::array<const char *, sizeof...(Ts)> cursors;
+            std::array<const char *, sizeof...(Ts)> ends;
+            for (size_t i = 0; i < sizeof...(Ts); ++i)
+            {
+                uint64_t bytes = 0;
+                if (!(in = read_varint(in, end, bytes)) || bytes > static_cast<uint64_t>(end - in))
+                    return nullptr;
+                cursors[i] = in;
+                ends[i] = in += bytes;
+            }
+
+            if (rows > out.max_size() - out.size())
+                return nullptr;
+            out.reserve(out.size() + static_cast<size_t>(rows));
+            previous_type previous{};
+            for (uint64_t r = 0; r < run_count; ++r)
+            {
+                uint64_t tag = 0, length = 0;
+                runs = read_varint(runs, end, tag);
+                runs = read_varint(runs, end, length);
+                if (tag == 0)
+                {
+                    out.resize(out.size() + length);
+                    continue;
+                }
+                auto i = static_cast<size_t>(tag - 1);
+                cursors[i] = decode_run_table[i](cursors[i], ends[i], length, previous, out);
+                if (!cursors[i])
+                    return nullptr;
+            }
+            for (size_t i = 0; i < sizeof...(Ts); ++i)
+                if (cursors[i] != ends[i])
+                    return nullptr;
+            return in;
+        }
+    };
+
+    // 解码 [in, end) 开头的一个块并追加到 out 末尾，返回块结束的位置；数据损坏时返回 nullptr，
+    // 此时 out 末尾可能留有该块中已解出的部分行，需要时由调用者按原来的大小截断
+    template <typename... Ts>
+    const char *decode_block(const char *in, const char *end, std::vector<Variant<Ts...>> &out)
+    {
+        return stream_decoder<Ts...>::decode_block(in, end, out);
+    }
+
+    // 解码 [in, end) 中的全部块；失败时 out 中保留此前已解出的行
+    template <typename... Ts>
+    bool decode_stream(const char *in, const char *end, std::vector<Variant<Ts...>> &out)
+    {
+        while (in != end)
+            if (!(in = decode_block(in, end, out)))
+                return false;
+        return true;
+    }
+}
+
+#endif // INCLUDE_VARIANT_STREAM